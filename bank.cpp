@@ -1,104 +1,192 @@
 #include "bank.h"
-#include <chrono>
-#include <ctime>
-#include <sstream>
-#include <iomanip>
+#include "metrics.h"
 #include <algorithm>
+#include <charconv>
+#include <cstdint>
 
-bool Bank::createAccount(const std::string& accountID, const std::string& ownerName, double initial) {
-    if (accounts.find(accountID) != accounts.end()) return false;
+bool Bank::createAccount(const std::string& accountID, const std::string& ownerName, Money initial) {
+    std::unique_lock<std::shared_mutex> lk(accountsMutex);
+    Sym id(accountID);
+    if (accounts.count(id)) return false;
     BankAccount a(accountID, ownerName, initial);
-    if (initial > 0) a.txs.push_back({todayDate(), initial, "initial"});
-    accounts[accountID] = a;
+    if (initial > Money()) {
+        a.txs.push_back({Date::today(), initial, "initial"});
+        a.resync();
+    }
+    BankAccount &stored = accounts[id] = a;
+    std::lock_guard<std::mutex> alk(activityMutex);
+    dormancy.touch(&stored, stored.lastDay);
+    if (initial > Money()) activity.add(stored.lastDay, accountID);
     return true;
 }
 
 BankAccount* Bank::getAccount(const std::string& accountID) {
-    auto it = accounts.find(accountID);
+    std::shared_lock<std::shared_mutex> lk(accountsMutex);
+    auto it = findByText(accounts, accountID);
     if (it == accounts.end()) return nullptr;
     return &it->second;
 }
 
-bool Bank::deposit(const std::string& accountID, double amount, const std::string& date, const std::string& note) {
+bool Bank::deposit(const std::string& accountID, Money amount, Date date, const std::string& note) {
+    OpTimer t(Op::DEPOSIT);
     BankAccount* a = getAccount(accountID);
-    if (!a) return false;
+    if (!a) return t.fail("unknown_account");
+    std::lock_guard<std::mutex> lk(accountLocks.forKey(accountID));
     a->deposit(amount, date, note);
+    noteActivity(*a, date);
+    if (wal) wal->append("DE|" + accountID + "|" + amount.str() + "|" + std::to_string(date.day) + "|" + note);
     return true;
 }
 
-bool Bank::withdraw(const std::string& accountID, double amount, const std::string& date, const std::string& note) {
+bool Bank::withdraw(const std::string& accountID, Money amount, Date date, const std::string& note) {
+    OpTimer t(Op::WITHDRAW);
     BankAccount* a = getAccount(accountID);
-    if (!a) return false;
-    return a->withdraw(amount, date, note);
+    if (!a) return t.fail("unknown_account");
+    std::lock_guard<std::mutex> lk(accountLocks.forKey(accountID));
+    if (!a->withdraw(amount, date, note)) return t.fail("insufficient_funds");
+    noteActivity(*a, date);
+    if (wal) wal->append("WD|" + accountID + "|" + amount.str() + "|" + std::to_string(date.day) + "|" + note);
+    return true;
+}
+
+void Bank::noteActivity(const BankAccount& account, Date date) {
+    std::lock_guard<std::mutex> lk(activityMutex);
+    activity.add(date, account.accountID);
+    dormancy.touch(&account, date);
+}
+
+void Bank::rebuildActivity() {
+    Date t = Date::today();
+    std::lock_guard<std::mutex> lk(activityMutex);
+    activity.clear();
+    dormancy.clear();
+    for (auto &p : accounts) {
+        p.second.resync();
+        int c = p.second.summary(t).todayCount;
+        if (c > 0) activity.add(t, p.first, c);
+        dormancy.touch(&p.second, p.second.lastDay);
+    }
 }
 
 std::vector<std::string> Bank::listCustomers() const {
+    OpTimer timer(Op::BANK_REPORT);
+    std::shared_lock<std::shared_mutex> lk(accountsMutex);
     std::vector<std::string> out;
-    for (auto &p : accounts) out.push_back(p.second.ownerName + " (" + p.first + ")");
+    for (auto *a : accountsByText()) out.push_back(a->ownerName + " (" + a->accountID + ")");
     return out;
 }
 
-std::vector<std::pair<std::string, double>> Bank::transactionsLastWeek() const {
-    std::vector<std::pair<std::string, double>> out;
-    std::string t = todayDate();
-    for (auto &p : accounts) {
-        for (auto &tx : p.second.txs) {
-            if (daysBetween(t, tx.date) <= 7) {
-                out.emplace_back(tx.date + " | " + p.second.ownerName, tx.amount);
-            }
-        }
-    }
+std::vector<const BankAccount*> Bank::accountsByText() const {
+    std::vector<const BankAccount*> out;
+    out.reserve(accounts.size());
+    for (auto &p : accounts) out.push_back(&p.second);
+    std::sort(out.begin(), out.end(), [](const BankAccount* a, const BankAccount* b) { return a->accountID < b->accountID; });
+    return out;
+}
+
+std::vector<std::pair<std::string, Money>> Bank::transactionsLastWeek() const {
+    std::vector<std::pair<std::string, Money>> out;
+    visitTransactionsLastWeek("", SIZE_MAX, [&out](const BankAccount& a, const BankTx& tx) {
+        out.emplace_back(tx.date.str() + " | " + a.ownerName, tx.amount);
+    });
     std::sort(out.begin(), out.end(), [](auto &a, auto &b){ return a.first > b.first; });
     return out;
 }
 
+std::string Bank::visitTransactionsLastWeek(const std::string& token, size_t limit, const TxRowVisitor& visit) const {
+    // token "<accountID>|<index in its txs>"
+    OpTimer timer(Op::BANK_REPORT);
+    Date t = Date::today();
+    std::string fromID;
+    size_t pos = 0;
+    size_t bar = token.rfind('|');
+    if (bar != std::string::npos) {
+        fromID = token.substr(0, bar);
+        std::from_chars(token.data() + bar + 1, token.data() + token.size(), pos);
+    }
+    std::shared_lock<std::shared_mutex> lk(accountsMutex);
+    Sym from;
+    auto it = bar == std::string::npos ? accounts.begin()
+              : Sym::find(fromID, from) ? accounts.lower_bound(from) : accounts.end(); // not an account: done
+    if (it != accounts.end() && it->first != from) pos = 0;
+    size_t n = 0;
+    for (; it != accounts.end(); ++it, pos = 0) {
+        std::lock_guard<std::mutex> alk(accountLocks.forKey(it->first));
+        const BankAccount &a = it->second;
+        if (a.txs.empty() || t - a.lastDay > 7) continue; // nothing in the window
+        if (a.datesInOrder) { // skip straight to the window
+            size_t first = std::partition_point(a.txs.begin(), a.txs.end(),
+                                                [t](const BankTx& tx) { return t - tx.date > 7; }) - a.txs.begin();
+            pos = std::max(pos, first);
+        }
+        for (; pos < a.txs.size(); ++pos) {
+            if (t - a.txs[pos].date > 7) continue;
+            if (n == limit) return it->first.str() + "|" + std::to_string(pos);
+            visit(a, a.txs[pos]);
+            ++n;
+        }
+    }
+    return "";
+}
+
 std::vector<std::string> Bank::dormantAccounts(int daysWithoutTx) const {
     std::vector<std::string> out;
-    std::string t = todayDate();
-    for (auto &p : accounts) {
-        if (p.second.txs.empty()) {
-            out.push_back(p.second.ownerName + " (" + p.first + ")");
-        } else {
-            std::string last = p.second.lastTransactionDate();
-            if (daysBetween(t, last) > daysWithoutTx) out.push_back(p.second.ownerName + " (" + p.first + ")");
-        }
+    for (auto &e : dormantPage(daysWithoutTx, DormancyIndex::Entry(), SIZE_MAX))
+        out.push_back(e.account->ownerName + " (" + e.account->accountID + ")");
+    return out;
+}
+
+std::vector<DormancyIndex::Entry> Bank::dormantPage(int daysWithoutTx, const DormancyIndex::Entry& after,
+                                                    size_t pageSize) const {
+    // idle for more than daysWithoutTx days <=> last activity before today - daysWithoutTx
+    OpTimer timer(Op::BANK_REPORT);
+    std::lock_guard<std::mutex> lk(activityMutex);
+    return dormancy.page(Date::today() - daysWithoutTx, after, pageSize);
+}
+
+std::vector<std::pair<std::string, AccountSummary>> Bank::accountSummaries() const {
+    OpTimer timer(Op::BANK_REPORT);
+    std::vector<std::pair<std::string, AccountSummary>> out;
+    Date t = Date::today();
+    std::shared_lock<std::shared_mutex> lk(accountsMutex);
+    out.reserve(accounts.size());
+    for (auto *a : accountsByText()) {
+        std::lock_guard<std::mutex> alk(accountLocks.forKey(a->accountID));
+        out.emplace_back(a->ownerName + " (" + a->accountID + ")", a->summary(t));
     }
     return out;
 }
 
 std::vector<std::pair<std::string, int>> Bank::topNActiveToday(int n) const {
-    std::map<std::string,int> counts;
-    std::string t = todayDate();
-    for (auto &p : accounts) {
-        int c = 0;
-        for (auto &tx : p.second.txs) if (tx.date == t) ++c;
-        if (c>0) counts[p.second.ownerName + " (" + p.first + ")"] = c;
+    OpTimer timer(Op::BANK_REPORT);
+    std::vector<std::pair<Sym, int>> top;
+    {
+        std::lock_guard<std::mutex> lk(activityMutex);
+        top = activity.top(Date::today(), n);
+    }
+    std::vector<std::pair<std::string, int>> vec;
+    vec.reserve(top.size());
+    std::shared_lock<std::shared_mutex> lk(accountsMutex);
+    for (auto &e : top) {
+        if (e.second <= 0) break;
+        auto it = accounts.find(e.first);
+        if (it != accounts.end()) vec.emplace_back(it->second.ownerName + " (" + it->first + ")", e.second);
     }
-    std::vector<std::pair<std::string,int>> vec(counts.begin(), counts.end());
-    std::sort(vec.begin(), vec.end(), [](auto &a, auto &b){ return a.second > b.second; });
-    if ((int)vec.size() > n) vec.resize(n);
     return vec;
 }
 
 int Bank::daysBetween(const std::string& d1, const std::string& d2) {
-    // parse YYYY-MM-DD
-    std::tm tm1 = {}, tm2 = {};
-    std::istringstream ss1(d1), ss2(d2);
-    ss1 >> std::get_time(&tm1, "%Y-%m-%d");
-    ss2 >> std::get_time(&tm2, "%Y-%m-%d");
-    std::time_t time1 = std::mktime(&tm1);
-    std::time_t time2 = std::mktime(&tm2);
-    if (time1== (std::time_t)-1 || time2 == (std::time_t)-1) return 0;
-    double diff = std::difftime(time1, time2);
-    return static_cast<int>(diff / (60*60*24));
+    Date a, b;
+    if (!Date::tryParse(d1.data(), d1.size(), a) || !Date::tryParse(d2.data(), d2.size(), b)) return 0;
+    return a - b;
 }
 
 std::string Bank::todayDate() {
-    using namespace std::chrono;
-    auto now = system_clock::now();
-    std::time_t t = system_clock::to_time_t(now);
-    std::tm tm = *std::localtime(&t);
-    std::ostringstream ss;
-    ss << std::put_time(&tm, "%Y-%m-%d");
-    return ss.str();
+    return Date::today().str();
+}
+
+std::string Bank::addDays(const std::string& date, int days) {
+    Date d;
+    if (!Date::tryParse(date.data(), date.size(), d)) return date;
+    return (d + days).str();
 }
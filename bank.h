@@ -2,29 +2,62 @@
 #define BANK_H
 
 #include "models.h"
+#include "dormancy_index.h"
+#include "leaderboard.h"
+#include "lock_stripes.h"
+#include "wal.h"
+#include <functional>
 #include <map>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <vector>
 
 class Bank {
 public:
-    std::map<std::string, BankAccount> accounts; // accountID -> account
+    std::map<Sym, BankAccount, Sym::ById> accounts; // accountID -> account, in creation order (see findByText)
+    WriteAheadLog* wal = nullptr; // logs deposit/withdraw when set
+
+    // Concurrency: accountsMutex guards the map's shape (exclusive only in createAccount);
+    // an account's balance and txs are guarded by its accountLocks stripe.
+    // Accounts are never erased outside the loaders, so BankAccount* stays valid.
+    mutable std::shared_mutex accountsMutex;
+    mutable LockStripes accountLocks;
+
+    // today's account-tx count per account (topNActiveToday) and accounts by last
+    // activity day (dormancy queries). activityMutex is taken last, inside any account stripe.
+    DailyLeaderboard activity;
+    DormancyIndex dormancy;
+    mutable std::mutex activityMutex;
 
     Bank() = default;
 
-    bool createAccount(const std::string& accountID, const std::string& ownerName, double initial = 0.0);
+    bool createAccount(const std::string& accountID, const std::string& ownerName, Money initial = Money());
     BankAccount* getAccount(const std::string& accountID);
-    bool deposit(const std::string& accountID, double amount, const std::string& date, const std::string& note = "");
-    bool withdraw(const std::string& accountID, double amount, const std::string& date, const std::string& note = "");
+    bool deposit(const std::string& accountID, Money amount, Date date, const std::string& note = "");
+    bool withdraw(const std::string& accountID, Money amount, Date date, const std::string& note = "");
+    void noteActivity(const BankAccount& account, Date date); // for account txs made without deposit/withdraw
+    void rebuildActivity(); // account summaries, today's board and the dormancy index, from history (after loading)
 
     std::vector<std::string> listCustomers() const;
-    std::vector<std::pair<std::string, double>> transactionsLastWeek() const;
-    std::vector<std::string> dormantAccounts(int daysWithoutTx = 30) const;
+    std::vector<std::pair<std::string, Money>> transactionsLastWeek() const;
+    // Paged form, rows in account map order (Sym id order) as references into the account, passed
+    // while its stripe is held; same token contract as Store::visitTransactionsLastKDays.
+    using TxRowVisitor = std::function<void(const BankAccount&, const BankTx&)>;
+    std::string visitTransactionsLastWeek(const std::string& token, size_t limit, const TxRowVisitor& visit) const;
+    std::vector<std::string> dormantAccounts(int daysWithoutTx = 30) const; // oldest activity first
+    // Same accounts, a page at a time and without formatting: pass a default Entry to
+    // start, then the last entry of the previous page. An empty page means done.
+    std::vector<DormancyIndex::Entry> dormantPage(int daysWithoutTx, const DormancyIndex::Entry& after,
+                                                  size_t pageSize) const;
     std::vector<std::pair<std::string, int>> topNActiveToday(int n) const;
+    std::vector<std::pair<std::string, AccountSummary>> accountSummaries() const; // 7/30-day in/out per account
+    std::vector<const BankAccount*> accountsByText() const; // sorted by ID, for reports (accountsMutex held)
 
-    // helper
+    // helper (string forms kept for callers holding YYYY-MM-DD text; Date is the fast path)
     static int daysBetween(const std::string& d1, const std::string& d2); // d1-d2
     static std::string todayDate();
+    static std::string addDays(const std::string& date, int days);
 };
 
 #endif // BANK_H
@@ -0,0 +1,314 @@
+#include "batch.h"
+#include "metrics.h"
+#include <charconv>
+
+namespace {
+
+// Whitespace-separated words of a command line; rest() is the unread tail, trimmed.
+class Words {
+public:
+    explicit Words(std::string_view s) : line(s) {}
+    std::string_view next() {
+        skip();
+        size_t end = line.find_first_of(" \t\r");
+        if (end == std::string_view::npos) end = line.size();
+        std::string_view w = line.substr(0, end);
+        line.remove_prefix(end);
+        return w;
+    }
+    std::string nextStr() { return std::string(next()); }
+    std::string rest() {
+        skip();
+        while (!line.empty() && (line.back() == ' ' || line.back() == '\t' || line.back() == '\r')) line.remove_suffix(1);
+        return std::string(line);
+    }
+    bool done() {
+        skip();
+        return line.empty();
+    }
+
+private:
+    void skip() {
+        while (!line.empty() && (line[0] == ' ' || line[0] == '\t' || line[0] == '\r')) line.remove_prefix(1);
+    }
+    std::string_view line;
+};
+
+template <class T> bool toNum(std::string_view s, T& v) {
+    auto r = std::from_chars(s.data(), s.data() + s.size(), v);
+    return r.ec == std::errc() && r.ptr == s.data() + s.size() && !s.empty();
+}
+
+bool toMoney(std::string_view s, Money& m) {
+    return !s.empty() && Money::tryParse(s.data(), s.size(), m);
+}
+
+const char* statusName(TransactionStatus s) {
+    switch (s) {
+    case TransactionStatus::PAID: return "PAID";
+    case TransactionStatus::COMPLETED: return "COMPLETED";
+    case TransactionStatus::CANCELED: return "CANCELED";
+    }
+    return "?";
+}
+
+// transactions.txt's field order, with the status spelled out
+void appendTx(std::string& out, const Transaction& t) {
+    out += t.transactionID.str();
+    out += '|';
+    out += t.date.str();
+    out += '|';
+    out += t.buyerID.str();
+    out += '|';
+    out += t.sellerID.str();
+    out += '|';
+    out += t.itemID.str();
+    out += '|';
+    out += t.itemName.str();
+    out += '|';
+    out += std::to_string(t.quantity);
+    out += '|';
+    out += t.totalPrice.str();
+    out += '|';
+    out += statusName(t.status);
+    out += '\n';
+}
+
+void appendItem(std::string& out, const Item& i) {
+    out += i.itemID;
+    out += '|';
+    out += i.name;
+    out += '|';
+    out += i.price.str();
+    out += '|';
+    out += std::to_string(i.stock);
+    out += '\n';
+}
+
+void appendRows(std::string& out, size_t n, const std::string& rows) {
+    out += "ok ";
+    out += std::to_string(n);
+    out += '\n';
+    out += rows;
+}
+
+template <class V> void appendCounts(std::string& out, const V& pairs) {
+    std::string rows;
+    for (auto &p : pairs) rows += p.first + "|" + std::to_string(p.second) + "\n";
+    appendRows(out, pairs.size(), rows);
+}
+
+void reply(std::string& out, bool ok, const char* failure) {
+    out += ok ? "ok\n" : std::string("err ") + failure + "\n";
+}
+
+void usage(std::string& out, const char* synopsis) {
+    out += "err usage: ";
+    out += synopsis;
+    out += '\n';
+}
+
+const char* kHelp =
+    "register_buyer register_seller login add_item set_price replenish discard purchase topup withdraw "
+    "complete cancel complete_pending pending items search date report stats help quit";
+
+} // namespace
+
+std::string_view BatchExecutor::verb(std::string_view line) {
+    std::string_view v = Words(line).next();
+    return !v.empty() && v[0] == '#' ? std::string_view() : v;
+}
+
+bool BatchExecutor::execute(std::string_view line, BatchSession& session, std::string& out) {
+    Words w(line);
+    std::string_view cmd = w.next();
+    if (cmd.empty() || cmd[0] == '#') return true;
+
+    if (cmd == "purchase") {
+        std::string buyer = w.nextStr(), item = w.nextStr();
+        int qty;
+        if (item.empty() || !toNum(w.next(), qty)) { usage(out, "purchase BUYER ITEM QTY"); return true; }
+        std::string tid = store.genID("TX");
+        PurchaseStatus st = store.tryPurchaseWithID(tid, buyer, item, qty, session.date);
+        if (st == PurchaseStatus::OK) out += "ok " + tid + "\n";
+        else out += std::string("err ") + purchaseStatusName(st) + "\n";
+    } else if (cmd == "topup" || cmd == "withdraw") {
+        std::string account = w.nextStr();
+        Money amount;
+        if (!toMoney(w.next(), amount) || amount < Money()) {
+            usage(out, cmd == "topup" ? "topup ACCOUNT AMOUNT [NOTE]" : "withdraw ACCOUNT AMOUNT [NOTE]");
+            return true;
+        }
+        std::string note = w.rest();
+        if (!store.bank) { out += "err no bank\n"; return true; }
+        if (cmd == "topup") reply(out, store.bank->deposit(account, amount, session.date, note.empty() ? "topup" : note), "unknown account");
+        else reply(out, store.bank->withdraw(account, amount, session.date, note.empty() ? "withdraw" : note), "unknown account or insufficient funds");
+    } else if (cmd == "login") {
+        std::string user = w.nextStr(), pass = w.nextStr();
+        User* u = store.login(user, pass);
+        if (u) out += "ok " + u->role + " " + u->userID + "\n";
+        else out += "err bad credentials\n";
+    } else if (cmd == "register_buyer" || cmd == "register_seller") {
+        std::string id = w.nextStr(), user = w.nextStr(), pass = w.nextStr();
+        if (pass.empty()) { usage(out, "register_buyer|register_seller ID USER PASS"); return true; }
+        bool ok = cmd == "register_buyer" ? store.registerBuyer(id, user, pass) : store.registerSeller(id, user, pass);
+        reply(out, ok, "ID or username taken");
+    } else if (cmd == "add_item") {
+        std::string seller = w.nextStr(), item = w.nextStr();
+        Money price;
+        int stock;
+        if (!toMoney(w.next(), price) || !toNum(w.next(), stock) || w.done()) {
+            usage(out, "add_item SELLER ITEM PRICE STOCK NAME");
+            return true;
+        }
+        reply(out, store.addItem(seller, item, w.rest(), price, stock), "unknown seller or item exists");
+    } else if (cmd == "set_price") {
+        std::string seller = w.nextStr(), item = w.nextStr();
+        Money price;
+        if (!toMoney(w.next(), price)) { usage(out, "set_price SELLER ITEM PRICE"); return true; }
+        reply(out, store.setItemPrice(seller, item, price), "unknown seller or item");
+    } else if (cmd == "replenish" || cmd == "discard") {
+        std::string seller = w.nextStr(), item = w.nextStr();
+        int qty;
+        if (!toNum(w.next(), qty)) { usage(out, "replenish|discard SELLER ITEM QTY"); return true; }
+        bool ok = cmd == "replenish" ? store.replenishItem(seller, item, qty) : store.discardItem(seller, item, qty);
+        reply(out, ok, "not the seller's item or bad quantity");
+    } else if (cmd == "complete") {
+        std::string seller = w.nextStr(), tid = w.nextStr();
+        reply(out, store.completeTransaction(seller, tid), "not the seller's PAID transaction");
+    } else if (cmd == "cancel") {
+        std::string user = w.nextStr(), tid = w.nextStr();
+        reply(out, store.cancelTransaction(user, tid, session.date), "not cancelable by this user");
+    } else if (cmd == "complete_pending") {
+        std::string seller = w.nextStr();
+        size_t max;
+        if (!toNum(w.next(), max)) { usage(out, "complete_pending SELLER MAX"); return true; }
+        out += "ok " + std::to_string(store.completePending(seller, max)) + "\n";
+    } else if (cmd == "pending") {
+        std::string seller = w.nextStr();
+        Transaction t;
+        out += "ok " + std::to_string(store.pendingCount(seller));
+        if (store.nextPending(seller, t)) out += " " + t.transactionID.str();
+        out += '\n';
+    } else if (cmd == "items") {
+        size_t limit = 100;
+        std::string_view l = w.next();
+        if (!l.empty() && !toNum(l, limit)) { usage(out, "items [LIMIT [AFTER]]"); return true; }
+        std::string rows;
+        auto page = store.listItems(w.nextStr(), limit);
+        for (auto &i : page) appendItem(rows, i);
+        appendRows(out, page.size(), rows);
+    } else if (cmd == "search") {
+        CatalogIndex::Query q;
+        size_t limit = 20;
+        std::string token;
+        const char* synopsis = "search [limit=N] [min=PRICE] [max=PRICE] [stock=N] [order=price|price_desc|catalog] "
+                               "[after=TOKEN] [WORDS]";
+        for (std::string_view a = w.next(); !a.empty(); a = w.next()) {
+            size_t eq = a.find('=');
+            if (eq == std::string_view::npos) {
+                q.text += std::string(a) + " ";
+                continue;
+            }
+            std::string_view key = a.substr(0, eq), val = a.substr(eq + 1);
+            bool ok = true;
+            if (key == "limit") ok = toNum(val, limit);
+            else if (key == "min") ok = toMoney(val, q.minPrice);
+            else if (key == "max") ok = toMoney(val, q.maxPrice);
+            else if (key == "stock") ok = toNum(val, q.minStock);
+            else if (key == "after") token = std::string(val);
+            else if (key == "order" && val == "price") q.order = CatalogIndex::Order::PRICE_ASC;
+            else if (key == "order" && val == "price_desc") q.order = CatalogIndex::Order::PRICE_DESC;
+            else if (key == "order" && val == "catalog") q.order = CatalogIndex::Order::CATALOG;
+            else ok = false;
+            if (!ok) { usage(out, synopsis); return true; }
+        }
+        std::vector<Item> page;
+        std::string next = store.searchItems(q, token, limit, page);
+        out += "ok " + std::to_string(page.size());
+        if (!next.empty()) out += " " + next;
+        out += '\n';
+        for (auto &i : page) appendItem(out, i);
+    } else if (cmd == "date") {
+        std::string_view d = w.next();
+        if (!Date::tryParse(d.data(), d.size(), session.date)) usage(out, "date YYYY-MM-DD");
+        else out += "ok\n";
+    } else if (cmd == "report") {
+        std::string_view what = w.next();
+        std::string rows;
+        size_t n = 0;
+        int k;
+        auto txRow = [&](const Transaction& t) { appendTx(rows, t); ++n; };
+        if (what == "tx_last_days" && toNum(w.next(), k)) {
+            store.visitTransactionsLastKDays(k, "", SIZE_MAX, txRow);
+            appendRows(out, n, rows);
+        } else if (what == "paid") {
+            store.visitPaidNotCompleted("", SIZE_MAX, txRow);
+            appendRows(out, n, rows);
+        } else if (what == "top_items" && toNum(w.next(), k)) {
+            appendCounts(out, store.mostFrequentItems(k));
+        } else if (what == "spending") {
+            std::string buyer = w.nextStr();
+            if (!toNum(w.next(), k)) { usage(out, "report spending BUYER K"); return true; }
+            out += "ok " + store.spendingLastKDays(buyer, k).str() + "\n";
+        } else if (what == "active_buyers" && toNum(w.next(), k)) {
+            appendCounts(out, store.mostActiveBuyersPerDay(k));
+        } else if (what == "active_sellers" && toNum(w.next(), k)) {
+            appendCounts(out, store.mostActiveSellersPerDay(k));
+        } else if (!store.bank) {
+            out += "err no bank\n";
+        } else if (what == "customers") {
+            auto names = store.bank->listCustomers();
+            for (auto &s : names) rows += s + "\n";
+            appendRows(out, names.size(), rows);
+        } else if (what == "bank_last_week") {
+            store.bank->visitTransactionsLastWeek("", SIZE_MAX, [&](const BankAccount& a, const BankTx& tx) {
+                rows += a.accountID + "|" + tx.date.str() + "|" + tx.amount.str() + "|" + tx.note.str() + "\n";
+                ++n;
+            });
+            appendRows(out, n, rows);
+        } else if (what == "dormant" && toNum(w.next(), k)) {
+            auto ids = store.bank->dormantAccounts(k);
+            for (auto &s : ids) rows += s + "\n";
+            appendRows(out, ids.size(), rows);
+        } else if (what == "active_accounts" && toNum(w.next(), k)) {
+            appendCounts(out, store.bank->topNActiveToday(k));
+        } else if (what == "summaries") {
+            auto sums = store.bank->accountSummaries();
+            for (auto &p : sums) {
+                const AccountSummary &s = p.second;
+                rows += p.first + "|" + std::to_string(s.todayCount) + "|" + s.in7.str() + "|" + s.out7.str()
+                      + "|" + s.in30.str() + "|" + s.out30.str() + "\n";
+            }
+            appendRows(out, sums.size(), rows);
+        } else {
+            usage(out, "report tx_last_days K|paid|top_items M|spending BUYER K|active_buyers N|active_sellers N"
+                       "|customers|bank_last_week|dormant DAYS|active_accounts N|summaries");
+        }
+    } else if (cmd == "stats") {
+        std::string_view arg = w.next();
+        if (arg == "reset") {
+            metrics().reset();
+            out += "ok\n";
+        } else if (arg.empty()) {
+            std::string rows;
+            auto dump = metrics().dump();
+            for (auto &r : dump) rows += r + "\n";
+            appendRows(out, dump.size(), rows);
+        } else {
+            usage(out, "stats [reset]");
+        }
+    } else if (cmd == "help") {
+        out += "ok ";
+        out += kHelp;
+        out += '\n';
+    } else if (cmd == "quit") {
+        out += "ok\n";
+        return false;
+    } else {
+        out += "err unknown command ";
+        out += cmd;
+        out += '\n';
+    }
+    return true;
+}
@@ -0,0 +1,43 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "store.h"
+#include <string>
+#include <string_view>
+
+// Per-stream state of a command stream (a batch file, a client connection).
+struct BatchSession {
+    Date date = Date::today(); // dates purchases, top-ups and cancels; set with "date YYYY-MM-DD"
+};
+
+// Runs one-line text commands against a Store and its Bank, without prompts:
+//   register_buyer ID USER PASS        register_seller ID USER PASS       login USER PASS
+//   add_item SELLER ITEM PRICE STOCK NAME...                             set_price SELLER ITEM PRICE
+//   replenish SELLER ITEM QTY          discard SELLER ITEM QTY
+//   purchase BUYER ITEM QTY            topup ACCOUNT AMOUNT [NOTE...]     withdraw ACCOUNT AMOUNT [NOTE...]
+//   complete SELLER TXID               cancel USER TXID                   complete_pending SELLER MAX
+//   pending SELLER                     items [LIMIT [AFTER]]              date YYYY-MM-DD
+//   search [limit=N] [min=PRICE] [max=PRICE] [stock=N] [order=price|price_desc|catalog] [after=TOKEN] [WORDS...]
+//   stats [reset]                      help                               quit
+//   report tx_last_days K | paid | top_items M | spending BUYER K | active_buyers N | active_sellers N
+//        | customers | bank_last_week | dormant DAYS | active_accounts N | summaries
+// Every command appends one response line, "ok[ value]" or "err <reason>"; reports, items and stats
+// answer "ok <rows>" followed by that many "|"-separated rows. Blank lines and "#" comments get
+// no response. Amounts are units with up to two decimals. A failed purchase names its
+// PurchaseStatus ("err out_of_stock"); stats rows are Metrics::dump() (metrics.h).
+// search answers "ok <rows>[ <next token>]", rows as items ("id|name|price|stock"); pass the
+// token back as after=TOKEN for the next page.
+// Thread-safe as the Store is: several streams may share one executor, each with its own session.
+class BatchExecutor {
+public:
+    explicit BatchExecutor(Store& s) : store(s) {}
+
+    // Returns false once the stream should stop ("quit").
+    bool execute(std::string_view line, BatchSession& session, std::string& out);
+    static std::string_view verb(std::string_view line); // the command word, "" for blank/comment lines
+
+private:
+    Store& store;
+};
+
+#endif // BATCH_H
@@ -0,0 +1,32 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+// Counts every heap allocation in the program by replacing the global operator new.
+// Include from exactly one translation unit of a benchmark.
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace bench {
+inline std::atomic<long> allocs{0};
+}
+
+void* operator new(std::size_t n) {
+    bench::allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+// std::pmr::new_delete_resource (the record pool's upstream) allocates through the aligned forms
+void* operator new(std::size_t n, std::align_val_t al) {
+    bench::allocs.fetch_add(1, std::memory_order_relaxed);
+    std::size_t a = (std::size_t)al;
+    if (void* p = std::aligned_alloc(a, (n + a - 1) / a * a)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+#endif // ALLOC_COUNTER_H
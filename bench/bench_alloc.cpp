@@ -0,0 +1,69 @@
+// Heap allocations and latency per Bank::deposit and Store::purchase, with the
+// record pool on and off. Every operator new in the process is counted, so the
+// figures include the pool's own upstream chunk allocations.
+// Usage: bench_alloc [accounts] [opsPerAccount]
+
+#include "bench_util.h"
+#include "alloc_counter.h"
+#include "bank.h"
+#include "store.h"
+#include <cstdlib>
+#include <iostream>
+
+static void report(const char* what, bool pooled, long ops, long a, double ns) {
+    std::cout << what << " pool=" << (pooled ? "on " : "off") << " ops=" << ops
+              << " allocs_per_op=" << (double)a / ops << " avg_ns=" << (long)(ns / ops) << "\n";
+}
+
+static void deposits(bool pooled, long accounts, long perAccount) {
+    setRecordPooling(pooled);
+    Bank bank;
+    std::vector<std::string> ids;
+    for (long i = 0; i < accounts; ++i) {
+        ids.push_back(bench::numberedID("A", i));
+        bank.createAccount(ids.back(), ids.back());
+    }
+    Date d = Date::today();
+    long before = bench::allocs.load();
+    bench::Timer t;
+    // round-robin, so every history grows a little at a time as it does in production
+    for (long k = 0; k < perAccount; ++k)
+        for (auto &id : ids) bank.deposit(id, Money::units(1), d, "topup");
+    report("Bank::deposit ", pooled, accounts * perAccount, bench::allocs.load() - before, t.elapsedNs());
+}
+
+static void purchases(bool pooled, long buyers, long perBuyer) {
+    setRecordPooling(pooled);
+    Bank bank;
+    Store store;
+    store.setBank(&bank);
+    const long sellers = 100, items = 1000;
+    for (long s = 0; s < sellers; ++s) {
+        std::string sid = bench::numberedID("S", s);
+        store.registerSeller(sid, sid, "pw");
+    }
+    std::vector<std::string> iids, bids;
+    for (long i = 0; i < items; ++i) {
+        iids.push_back(bench::numberedID("I", i));
+        store.addItem(bench::numberedID("S", i % sellers), iids.back(), "Item " + std::to_string(i), Money::units(1), 1 << 30);
+    }
+    Date d = Date::today();
+    for (long b = 0; b < buyers; ++b) {
+        bids.push_back(bench::numberedID("B", b));
+        store.registerBuyer(bids.back(), bids.back(), "pw");
+        bank.deposit(bids.back(), Money::units(1000000000), d, "bench");
+    }
+    long ops = buyers * perBuyer;
+    long before = bench::allocs.load();
+    bench::Timer t;
+    for (long n = 0; n < ops; ++n) store.purchase(bids[n % buyers], iids[(n * 7919) % items], 1, d);
+    report("Store::purchase", pooled, ops, bench::allocs.load() - before, t.elapsedNs());
+}
+
+int main(int argc, char** argv) {
+    long accounts = argc > 1 ? std::atol(argv[1]) : 100000;
+    long perAccount = argc > 2 ? std::atol(argv[2]) : 20;
+    for (bool pooled : {false, true}) deposits(pooled, accounts, perAccount);
+    for (bool pooled : {false, true}) purchases(pooled, accounts / 10, perAccount);
+    return 0;
+}
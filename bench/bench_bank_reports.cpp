@@ -0,0 +1,43 @@
+// Bank report latency as account histories grow. Most of each history is older
+// than the report windows, as it is for a long-running bank.
+// Usage: bench_bank_reports [accounts]
+
+#include "bench_util.h"
+#include "bank.h"
+#include <cstdlib>
+#include <iostream>
+
+template <class F> static double timeMs(F fn) {
+    bench::Timer t;
+    fn();
+    return t.elapsedMs();
+}
+
+static void run(long accounts, int txsPerAccount) {
+    Bank bank;
+    Date today = Date::today();
+    for (long a = 0; a < accounts; ++a) {
+        std::string id = bench::numberedID("A", a);
+        bank.createAccount(id, id);
+        BankAccount* acc = bank.getAccount(id);
+        // one tx per day up to today, newest last
+        for (int k = txsPerAccount - 1; k >= 0; --k) acc->deposit(Money::units(1), today - k, "topup");
+    }
+
+    size_t rows = 0;
+    double week = timeMs([&]() { rows += bank.transactionsLastWeek().size(); });
+    double dormant = timeMs([&]() { rows += bank.dormantAccounts(30).size(); });
+    double summaries = timeMs([&]() { rows += bank.accountSummaries().size(); });
+    double summariesAgain = timeMs([&]() { rows += bank.accountSummaries().size(); });
+
+    std::cout << "accounts=" << accounts << " txs_per_account=" << txsPerAccount
+              << " lastWeek_ms=" << week << " dormant_ms=" << dormant
+              << " summaries_ms=" << summaries << " summaries_cached_ms=" << summariesAgain
+              << " rows=" << rows << "\n";
+}
+
+int main(int argc, char** argv) {
+    long accounts = argc > 1 ? std::atol(argv[1]) : 10000;
+    for (int h : {10, 100, 1000}) run(accounts, h);
+    return 0;
+}
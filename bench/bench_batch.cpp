@@ -0,0 +1,71 @@
+// Checkout throughput: one Store::purchase per line vs. Store::purchaseBatch over carts.
+// Usage: bench_batch [lines] [cart_size] [batch_carts]
+
+#include "bench_util.h"
+#include "bank.h"
+#include "store.h"
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+static void setup(Store& store, Bank& bank, int buyers, int sellers, int items) {
+    store.setBank(&bank);
+    for (int s = 0; s < sellers; ++s) {
+        std::string sid = bench::numberedID("S", s);
+        store.registerSeller(sid, sid, "pw");
+    }
+    for (int i = 0; i < items; ++i)
+        store.addItem(bench::numberedID("S", i % sellers), bench::numberedID("I", i), "item", Money::units(2), 1 << 30);
+    for (int b = 0; b < buyers; ++b) {
+        std::string bid = bench::numberedID("B", b);
+        store.registerBuyer(bid, bid, "pw");
+        bank.deposit(bid, Money::units(1000000000000), Date::today(), "seed");
+    }
+}
+
+int main(int argc, char** argv) {
+    long total = argc > 1 ? std::atol(argv[1]) : 200000;
+    int cartSize = argc > 2 ? std::atoi(argv[2]) : 8;
+    int cartsPerBatch = argc > 3 ? std::atoi(argv[3]) : 64;
+    const int buyers = 10000, sellers = 200, items = 20000;
+
+    std::mt19937_64 rng(3);
+    std::uniform_int_distribution<int> pickB(0, buyers - 1), pickI(0, items - 1);
+    std::vector<PurchaseLine> lines;
+    lines.reserve(total);
+    while ((long)lines.size() < total) {
+        std::string bid = bench::numberedID("B", pickB(rng));
+        for (int k = 0; k < cartSize && (long)lines.size() < total; ++k)
+            lines.push_back({bid, bench::numberedID("I", pickI(rng)), 1});
+    }
+    Date d = Date::today();
+
+    {
+        Bank bank;
+        Store store;
+        setup(store, bank, buyers, sellers, items);
+        bench::Timer t;
+        long ok = 0;
+        for (auto &ln : lines) ok += store.purchase(ln.buyerID, ln.itemID, ln.qty, d);
+        double s = t.elapsedMs() / 1000.0;
+        std::cout << "single purchase: lines=" << ok << " lines_per_sec=" << (long)(lines.size() / s) << "\n";
+    }
+    {
+        Bank bank;
+        Store store;
+        setup(store, bank, buyers, sellers, items);
+        size_t per = (size_t)cartSize * cartsPerBatch;
+        std::vector<std::vector<PurchaseLine>> batches;
+        for (size_t i = 0; i < lines.size(); i += per)
+            batches.emplace_back(lines.begin() + i, lines.begin() + std::min(lines.size(), i + per));
+        bench::Timer t;
+        long ok = 0;
+        for (auto &batch : batches) {
+            for (auto &r : store.purchaseBatch(batch, d)) ok += r.status == PurchaseStatus::OK;
+        }
+        double s = t.elapsedMs() / 1000.0;
+        std::cout << "purchaseBatch (" << per << " lines/batch): lines=" << ok
+                  << " lines_per_sec=" << (long)(lines.size() / s) << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,59 @@
+// Analytics scan throughput: map<txID, Transaction> layout vs. the columnar TxColumns copy.
+// Usage: bench_columnar [transactions]
+
+#include "bench_util.h"
+#include "bank.h"
+#include "store.h"
+#include <cstdlib>
+#include <iostream>
+#include <map>
+
+template <class F> static void report(const char* name, size_t rows, F fn) {
+    bench::Timer t;
+    size_t r = fn();
+    double ms = t.elapsedMs();
+    std::cout << name << ": result=" << r << " time_ms=" << ms
+              << " rows_per_sec=" << (long)(rows / (ms / 1000.0)) << "\n";
+}
+
+int main(int argc, char** argv) {
+    long txs = argc > 1 ? std::atol(argv[1]) : 2000000;
+    Bank bank;
+    Store store;
+    store.setBank(&bank);
+    Date today = Date::today();
+    for (long i = 0; i < txs; ++i) {
+        std::string tid = bench::numberedID("TX", i);
+        store.transactions[tid] = Transaction(tid, today - (int)(i % 90), bench::numberedID("B", i % 5000),
+                                              bench::numberedID("S", i % 300), bench::numberedID("I", i % 20000), "Item",
+                                              1, Money::units(1), i % 10 ? TransactionStatus::COMPLETED : TransactionStatus::PAID);
+    }
+    store.rebuildIndexes();
+    bench::Timer t;
+    TxColumns cols = store.transactionColumns();
+    std::cout << "columnar build ms=" << t.elapsedMs() << " rows=" << cols.size() << "\n";
+
+    // PAID rows: only count them, so both sides measure the scan rather than copying results
+    report("map scan: PAID rows", txs, [&]() {
+        size_t n = 0;
+        for (auto &p : store.transactions) n += p.second.status == TransactionStatus::PAID;
+        return n;
+    });
+    report("columnar: PAID rows", txs, [&]() {
+        return cols.rowsWithStatus(TransactionStatus::PAID).size();
+    });
+
+    // per-buyer counts over the last 7 days
+    report("map scan: buyers active in 7 days", txs, [&]() {
+        std::map<std::string, int> counts;
+        for (auto &p : store.transactions)
+            if (today - p.second.date <= 7) counts[p.second.buyerID]++;
+        return counts.size();
+    });
+    report("columnar: buyers active in 7 days", txs, [&]() {
+        size_t n = 0;
+        for (int c : cols.countByBuyer(today - 7, today)) n += c > 0;
+        return n;
+    });
+    return 0;
+}
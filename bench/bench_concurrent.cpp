@@ -0,0 +1,89 @@
+// Multithreaded purchase + top-up stress run. Checks afterwards that money is
+// conserved (balances == seeded + topped up) and stock is conserved
+// (stock + sold == seeded) for every item, and that every purchase kept its own transaction ID.
+// Usage: bench_concurrent [threads] [ops_per_thread] [buyers] [sellers] [items]
+
+#include "bench_util.h"
+#include "bank.h"
+#include "store.h"
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+
+int main(int argc, char** argv) {
+    int threads = argc > 1 ? std::atoi(argv[1]) : 8;
+    long ops = argc > 2 ? std::atol(argv[2]) : 100000;
+    int buyers = argc > 3 ? std::atoi(argv[3]) : 1000;
+    int sellers = argc > 4 ? std::atoi(argv[4]) : 100;
+    int items = argc > 5 ? std::atoi(argv[5]) : 5000;
+    const int initialStock = 50;
+    const Money initialBalance = Money::units(500);
+
+    Bank bank;
+    Store store;
+    store.setBank(&bank);
+    Date today = Date::today();
+    for (int s = 0; s < sellers; ++s) {
+        std::string sid = bench::numberedID("S", s);
+        store.registerSeller(sid, sid, "pw");
+    }
+    for (int i = 0; i < items; ++i) {
+        store.addItem(bench::numberedID("S", i % sellers), bench::numberedID("I", i), "item", Money(99 + i % 20 * 100), initialStock); // x.99
+    }
+    for (int b = 0; b < buyers; ++b) {
+        std::string bid = bench::numberedID("B", b);
+        store.registerBuyer(bid, bid, "pw");
+        bank.deposit(bid, initialBalance, today, "seed");
+    }
+
+    std::atomic<long> purchased{0}, toppedUp{0}, unitsSold{0}; // toppedUp in cents
+    auto worker = [&](int seed) {
+        std::mt19937_64 rng(seed);
+        std::uniform_int_distribution<int> pickB(0, buyers - 1), pickI(0, items - 1), pickQ(1, 3), pickOp(0, 9);
+        long localBought = 0, localUnits = 0, localTopup = 0;
+        for (long n = 0; n < ops; ++n) {
+            std::string bid = bench::numberedID("B", pickB(rng));
+            if (pickOp(rng) == 0) {
+                if (bank.deposit(bid, Money(2501), today, "topup")) localTopup += 2501;
+            } else {
+                int q = pickQ(rng);
+                if (store.purchase(bid, bench::numberedID("I", pickI(rng)), q, today)) {
+                    ++localBought;
+                    localUnits += q;
+                }
+            }
+        }
+        purchased += localBought;
+        unitsSold += localUnits;
+        toppedUp += localTopup;
+    };
+
+    bench::Timer t;
+    std::vector<std::thread> pool;
+    for (int i = 0; i < threads; ++i) pool.emplace_back(worker, 1000 + i);
+    for (auto &th : pool) th.join();
+    double ms = t.elapsedMs();
+
+    Money money;
+    for (auto &p : bank.accounts) money += p.second.balance;
+    Money expectedMoney = initialBalance * buyers + Money(toppedUp.load());
+    long stockOk = 0, sold = 0;
+    for (auto &p : store.items) {
+        stockOk += p.second.stock + p.second.soldCount == initialStock;
+        sold += p.second.soldCount;
+    }
+    size_t orders = 0;
+    for (auto &p : store.buyers) orders += p.second.orderIDs.size();
+
+    bool ok = money == expectedMoney && stockOk == items && sold == unitsSold.load()
+           && (long)orders == purchased.load() && (long)store.transactions.size() == purchased.load();
+    std::cout << "threads=" << threads << " ops=" << threads * ops << " time_ms=" << ms
+              << " ops_per_sec=" << (long)(threads * ops / (ms / 1000.0))
+              << " purchases=" << purchased << " units=" << unitsSold
+              << " money=" << money << "/" << expectedMoney
+              << " items_ok=" << stockOk << "/" << items
+              << " invariants=" << (ok ? "OK" : "VIOLATED") << "\n";
+    return ok ? 0 : 1;
+}
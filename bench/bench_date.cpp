@@ -0,0 +1,54 @@
+// Date difference cost: the old stream/mktime parser vs. Date day numbers.
+// Usage: bench_date [iterations]
+
+#include "bench_util.h"
+#include "bank.h"
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+// the pre-Date implementation of Bank::daysBetween
+static int streamDaysBetween(const std::string& d1, const std::string& d2) {
+    std::tm tm1 = {}, tm2 = {};
+    std::istringstream ss1(d1), ss2(d2);
+    ss1 >> std::get_time(&tm1, "%Y-%m-%d");
+    ss2 >> std::get_time(&tm2, "%Y-%m-%d");
+    std::time_t time1 = std::mktime(&tm1);
+    std::time_t time2 = std::mktime(&tm2);
+    if (time1== (std::time_t)-1 || time2 == (std::time_t)-1) return 0;
+    double diff = std::difftime(time1, time2);
+    return static_cast<int>(diff / (60*60*24));
+}
+
+int main(int argc, char** argv) {
+    long n = argc > 1 ? std::atol(argv[1]) : 1000000;
+    Date today = Date::today();
+    std::vector<std::string> text;
+    std::vector<Date> days;
+    for (long i = 0; i < 1000; ++i) {
+        days.push_back(today - (int)i);
+        text.push_back(days.back().str());
+    }
+    std::string t = today.str();
+
+    long sum = 0;
+    bench::Timer timer;
+    for (long i = 0; i < n; ++i) sum += streamDaysBetween(t, text[i % 1000]);
+    double streamNs = timer.elapsedNs() / n;
+
+    timer.reset();
+    for (long i = 0; i < n; ++i) sum += Bank::daysBetween(t, text[i % 1000]);
+    double parseNs = timer.elapsedNs() / n;
+
+    timer.reset();
+    for (long i = 0; i < n; ++i) sum += Date::today() - days[i % 1000];
+    double dateNs = timer.elapsedNs() / n;
+
+    std::cout << "stream+mktime ns/op=" << streamNs
+              << " hand-parsed ns/op=" << parseNs
+              << " Date ns/op=" << dateNs
+              << " (checksum " << sum << ")\n";
+    return 0;
+}
@@ -0,0 +1,54 @@
+// Dormancy sweep over many accounts: the last-activity index (range read, formatted
+// or paged) against a scan of every account, for a broad and a narrow cutoff.
+// Usage: bench_dormant [accounts] [pageSize]
+
+#include "bench_util.h"
+#include "bank.h"
+#include <cstdlib>
+#include <iostream>
+
+template <class F> static double timeMs(F fn) {
+    bench::Timer t;
+    fn();
+    return t.elapsedMs();
+}
+
+int main(int argc, char** argv) {
+    long accounts = argc > 1 ? std::atol(argv[1]) : 500000;
+    size_t pageSize = argc > 2 ? std::atol(argv[2]) : 1000;
+    Bank bank;
+    Date today = Date::today();
+    for (long a = 0; a < accounts; ++a) {
+        std::string id = bench::numberedID("A", a);
+        bank.createAccount(id, id);
+        bank.deposit(id, Money::units(1), today - (int)((a * 7919) % 365), "topup");
+    }
+
+    for (int days : {30, 330}) {
+        size_t scanRows = 0, listRows = 0, pagedRows = 0;
+        double scan = timeMs([&]() {
+            std::vector<std::string> out;
+            for (auto &p : bank.accounts) {
+                std::lock_guard<std::mutex> alk(bank.accountLocks.forKey(p.first));
+                if (p.second.txs.empty() || today - p.second.lastDay > days)
+                    out.push_back(p.second.ownerName + " (" + p.first + ")");
+            }
+            scanRows = out.size();
+        });
+        double list = timeMs([&]() { listRows = bank.dormantAccounts(days).size(); });
+        double paged = timeMs([&]() {
+            DormancyIndex::Entry cursor;
+            for (;;) {
+                auto page = bank.dormantPage(days, cursor, pageSize);
+                if (page.empty()) break;
+                pagedRows += page.size();
+                cursor = page.back();
+            }
+        });
+        std::cout << "accounts=" << accounts << " days=" << days << " matches=" << listRows
+                  << " scan_ms=" << scan << " index_strings_ms=" << list
+                  << " index_paged_ms=" << paged << " (page=" << pageSize << ")"
+                  << " agree=" << (scanRows == listRows && listRows == pagedRows) << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+// Top-N report latency as history grows: the incrementally kept leaderboards
+// against a scan-and-sort over the same data (what the reports used to do).
+// Usage: bench_leaderboard [topN]
+
+#include "bench_util.h"
+#include "bank.h"
+#include "store.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+
+static volatile size_t sink; // keeps the measured calls from being optimized away
+
+template <class F> static double timeUs(F fn, int reps = 20) {
+    bench::Timer t;
+    for (int r = 0; r < reps; ++r) sink = sink + fn();
+    return t.elapsedNs() / reps / 1000.0;
+}
+
+static void run(long txs, int topN) {
+    const long buyers = 20000, sellers = 1000, items = 50000;
+    Bank bank;
+    Store store;
+    store.setBank(&bank);
+    for (long s = 0; s < sellers; ++s) {
+        std::string sid = bench::numberedID("S", s);
+        store.registerSeller(sid, sid, "pw");
+    }
+    for (long i = 0; i < items; ++i)
+        store.addItem(bench::numberedID("S", i % sellers), bench::numberedID("I", i), "Item " + std::to_string(i), Money::units(1), 1 << 30);
+    for (long b = 0; b < buyers; ++b) {
+        std::string bid = bench::numberedID("B", b);
+        store.registerBuyer(bid, bid, "pw");
+    }
+    Date today = Date::today();
+    for (long n = 0; n < txs; ++n) {
+        Sym tid(store.genID("TX"));
+        std::string bid = bench::numberedID("B", (n * 31) % buyers);
+        long item = (n * 7919) % items;
+        std::string iid = bench::numberedID("I", item);
+        std::string sid = bench::numberedID("S", item % sellers);
+        Date d = today - (int)(n % 30);
+        store.transactions[tid] = Transaction(tid, d, bid, sid, iid, "Item " + std::to_string(item), 1, Money::units(1),
+                                              TransactionStatus::PAID);
+        store.items[iid].soldCount += 1;
+        bank.getAccount(bid)->withdraw(Money(), d, "purchase");
+        bank.getAccount(sid)->deposit(Money(), d, "sale");
+    }
+    store.rebuildIndexes();
+
+    double scanBuyers = timeUs([&]() {
+        std::map<std::string, int> counts;
+        auto d = store.txByDay.find(today);
+        if (d != store.txByDay.end())
+            for (auto *t : d->second) counts[t->buyerID]++;
+        std::vector<std::pair<std::string, int>> vec(counts.begin(), counts.end());
+        std::sort(vec.begin(), vec.end(), [](auto &a, auto &b) { return a.second > b.second; });
+        if ((int)vec.size() > topN) vec.resize(topN);
+        return vec.size();
+    });
+    double scanItems = timeUs([&]() {
+        std::vector<std::pair<std::string, int>> vec;
+        for (auto &p : store.items) vec.emplace_back(p.second.name, p.second.soldCount);
+        std::sort(vec.begin(), vec.end(), [](auto &a, auto &b) { return a.second > b.second; });
+        if ((int)vec.size() > topN) vec.resize(topN);
+        return vec.size();
+    });
+    double scanAccounts = timeUs([&]() {
+        std::map<std::string, int> counts;
+        for (auto &p : bank.accounts) {
+            int c = 0;
+            for (auto &tx : p.second.txs) c += tx.date == today;
+            if (c > 0) counts[p.second.ownerName + " (" + p.first + ")"] = c;
+        }
+        std::vector<std::pair<std::string, int>> vec(counts.begin(), counts.end());
+        std::sort(vec.begin(), vec.end(), [](auto &a, auto &b) { return a.second > b.second; });
+        if ((int)vec.size() > topN) vec.resize(topN);
+        return vec.size();
+    }, 3);
+
+    double boardBuyers = timeUs([&]() { return store.mostActiveBuyersPerDay(topN).size(); });
+    double boardItems = timeUs([&]() { return store.mostFrequentItems(topN).size(); });
+    double boardAccounts = timeUs([&]() { return bank.topNActiveToday(topN).size(); });
+
+    std::cout << "transactions=" << txs << " topN=" << topN
+              << " | buyersPerDay scan_us=" << scanBuyers << " board_us=" << boardBuyers
+              << " | frequentItems scan_us=" << scanItems << " board_us=" << boardItems
+              << " | accountsToday scan_us=" << scanAccounts << " board_us=" << boardAccounts << "\n";
+}
+
+int main(int argc, char** argv) {
+    int topN = argc > 1 ? std::atoi(argv[1]) : 10;
+    for (long txs : {10000L, 100000L, 1000000L}) run(txs, topN);
+    return 0;
+}
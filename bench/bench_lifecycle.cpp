@@ -0,0 +1,82 @@
+// Transaction lifecycle: the PAID-order report by full scan of the transaction table
+// against the paid index, per-seller fulfilment (nextPending / completePending, bulk
+// against one completeTransaction per ID), and cancel latency.
+// Usage: bench_lifecycle [orders] [sellers]
+
+#include "bench_util.h"
+#include "bank.h"
+#include "store.h"
+#include <cstdlib>
+#include <iostream>
+
+int main(int argc, char** argv) {
+    long orders = argc > 1 ? std::atol(argv[1]) : 200000;
+    long sellers = argc > 2 ? std::atol(argv[2]) : 100;
+    Bank bank;
+    Store store;
+    store.setBank(&bank);
+    Date today = Date::today();
+    for (long s = 0; s < sellers; ++s) {
+        std::string id = bench::numberedID("S", s);
+        store.registerSeller(id, "u" + id, "p");
+        store.addItem(id, bench::numberedID("I", s), "Item", Money::units(1), 1 << 30);
+    }
+    for (long b = 0; b < 1000; ++b) {
+        std::string id = bench::numberedID("B", b);
+        store.registerBuyer(id, "u" + id, "p");
+        bank.deposit(id, Money::units(1000000000000), today, "topup");
+    }
+    bench::Timer t;
+    for (long i = 0; i < orders; ++i)
+        store.purchase(bench::numberedID("B", i % 1000), bench::numberedID("I", i % sellers), 1, today);
+    std::cout << "setup: " << orders << " purchases in " << t.elapsedMs() << " ms\n";
+
+    // complete 90% so PAID orders are a minority, as in a long-running store
+    for (long s = 0; s < sellers; ++s)
+        store.completePending(bench::numberedID("S", s), orders / sellers * 9 / 10);
+
+    t.reset();
+    size_t scanned = 0;
+    for (auto &p : store.transactions)
+        if (p.second.status == TransactionStatus::PAID) ++scanned;
+    double scanMs = t.elapsedMs();
+    t.reset();
+    size_t indexed = 0;
+    store.visitPaidNotCompleted("", SIZE_MAX, [&](const Transaction&) { ++indexed; });
+    std::cout << "PAID orders: full scan " << scanned << " in " << scanMs << " ms, paid index "
+              << indexed << " in " << t.elapsedMs() << " ms\n";
+
+    std::string s0 = bench::numberedID("S", 0);
+    Transaction next;
+    t.reset();
+    const int peeks = 100000;
+    for (int i = 0; i < peeks; ++i) store.nextPending(s0, next);
+    std::cout << "nextPending: " << t.elapsedNs() / peeks << " ns/op (" << store.pendingCount(s0) << " pending)\n";
+
+    // bulk against per-ID, over the same number of orders on two sellers
+    std::string s1 = bench::numberedID("S", 1), s2 = bench::numberedID("S", 2);
+    size_t n = store.pendingCount(s1);
+    std::vector<std::string> ids;
+    store.visitPaidNotCompleted("", SIZE_MAX, [&](const Transaction& x) {
+        if (x.sellerID == s2) ids.push_back(x.transactionID);
+    });
+    t.reset();
+    size_t bulk = store.completePending(s1, n);
+    double bulkNs = t.elapsedNs();
+    t.reset();
+    for (auto &id : ids) store.completeTransaction(s2, id);
+    double oneNs = t.elapsedNs();
+    std::cout << "complete: bulk " << bulkNs / (bulk ? bulk : 1) << " ns/order, per-ID "
+              << oneNs / (ids.empty() ? 1 : ids.size()) << " ns/order\n";
+
+    ids.clear();
+    store.visitPaidNotCompleted("", SIZE_MAX, [&](const Transaction& x) { ids.push_back(x.transactionID); });
+    t.reset();
+    for (auto &id : ids) store.cancelTransaction(next.buyerID, id, today); // only that buyer's orders succeed
+    double cancelNs = t.elapsedNs();
+    size_t canceled = 0;
+    for (auto &id : ids) canceled += findByText(store.transactions, id)->second.status == TransactionStatus::CANCELED;
+    std::cout << "cancel: " << ids.size() << " attempts (" << canceled << " canceled) at "
+              << cancelNs / (ids.empty() ? 1 : ids.size()) << " ns/attempt\n";
+    return 0;
+}
@@ -0,0 +1,80 @@
+// Startup load time: text files (DataManager::loadStore) vs. binary snapshot (loadSnapshot).
+// Usage: bench_load [users] [items] [transactions] [scratch_folder] [threads]
+
+#include "bench_util.h"
+#include "bank.h"
+#include "data_manager.h"
+#include "store.h"
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <sys/stat.h>
+
+int main(int argc, char** argv) {
+    long users = argc > 1 ? std::atol(argv[1]) : 100000;
+    long items = argc > 2 ? std::atol(argv[2]) : 100000;
+    long txs = argc > 3 ? std::atol(argv[3]) : 1000000;
+    std::string folder = argc > 4 ? argv[4] : "bench_load_data";
+    unsigned threads = argc > 5 ? (unsigned)std::atoi(argv[5]) : 0;
+    mkdir(folder.c_str(), 0755);
+
+    {
+        Bank bank;
+        Store store;
+        store.setBank(&bank);
+        Date today = Date::today();
+        store.registerSeller("S0", "seller0", "pw");
+        for (long i = 0; i < items; ++i) {
+            std::string iid = bench::numberedID("I", i);
+            store.addItem("S0", iid, "Item " + iid, Money::units(1 + i % 100), 1000);
+        }
+        for (long i = 0; i < users; ++i) {
+            std::string bid = bench::numberedID("B", i);
+            store.registerBuyer(bid, bench::numberedID("buyer", i), "pw");
+            bank.deposit(bid, Money::units(100), today - (int)(i % 60), "topup");
+        }
+        for (long i = 0; i < txs; ++i) {
+            std::string tid = bench::numberedID("TX", i);
+            std::string bid = bench::numberedID("B", i % users);
+            std::string iid = bench::numberedID("I", i % items);
+            store.transactions[tid] = Transaction(tid, today - (int)(i % 365), bid, "S0", iid, "Item " + iid,
+                                                  1, Money::units(1), TransactionStatus::PAID);
+            store.buyers[bid].orderIDs.push_back(tid);
+            store.sellers["S0"].saleTxIDs.push_back(tid);
+        }
+
+        bench::Timer t;
+        DataManager::saveStore(store, folder);
+        std::cout << "text save ms=" << t.elapsedMs() << "\n";
+        t.reset();
+        DataManager::saveSnapshot(store, folder + "/" + DataManager::snapshotFile());
+        std::cout << "snapshot save ms=" << t.elapsedMs() << "\n";
+    }
+
+    Bank textBank;
+    Store textStore;
+    textStore.setBank(&textBank);
+    bench::Timer t;
+    DataManager::loadStore(textStore, folder);
+    std::cout << "text load ms=" << t.elapsedMs() << " txs=" << textStore.transactions.size() << "\n";
+
+    Bank parBank;
+    Store parStore;
+    parStore.setBank(&parBank);
+    t.reset();
+    DataManager::loadStoreParallel(parStore, folder, threads);
+    bool same = parStore.transactions.size() == textStore.transactions.size()
+             && parBank.accounts.size() == textBank.accounts.size()
+             && parStore.items.size() == textStore.items.size();
+    std::cout << "parallel text load ms=" << t.elapsedMs() << " threads="
+              << (threads ? threads : std::thread::hardware_concurrency()) << " matches_serial=" << same << "\n";
+
+    Bank snapBank;
+    Store snapStore;
+    snapStore.setBank(&snapBank);
+    t.reset();
+    bool ok = DataManager::loadSnapshot(snapStore, folder + "/" + DataManager::snapshotFile());
+    std::cout << "snapshot load ms=" << t.elapsedMs() << " ok=" << ok
+              << " txs=" << snapStore.transactions.size() << "\n";
+    return 0;
+}
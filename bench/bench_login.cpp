@@ -0,0 +1,41 @@
+// Login throughput against a large user population.
+// Usage: bench_login [users] [logins]
+
+#include "bench_util.h"
+#include "bank.h"
+#include "store.h"
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+int main(int argc, char** argv) {
+    long users = argc > 1 ? std::atol(argv[1]) : 1000000;
+    long logins = argc > 2 ? std::atol(argv[2]) : 1000000;
+
+    Bank bank;
+    Store store;
+    store.setBank(&bank);
+
+    bench::Timer t;
+    for (long i = 0; i < users; ++i) {
+        std::string id = bench::numberedID(i % 2 ? "S" : "B", i);
+        std::string uname = bench::numberedID("user", i);
+        if (i % 2) store.registerSeller(id, uname, "pw");
+        else store.registerBuyer(id, uname, "pw");
+    }
+    std::cout << "registered " << users << " users in " << t.elapsedMs() << " ms\n";
+
+    std::mt19937_64 rng(7);
+    std::uniform_int_distribution<long> pick(0, users - 1);
+    std::vector<std::string> names;
+    names.reserve(logins);
+    for (long i = 0; i < logins; ++i) names.push_back(bench::numberedID("user", pick(rng)));
+
+    t.reset();
+    long ok = 0;
+    for (auto &n : names) ok += store.login(n, "pw") != nullptr;
+    double ms = t.elapsedMs();
+    std::cout << "logins=" << ok << "/" << logins << " time_ms=" << ms
+              << " logins_per_sec=" << (long)(logins / (ms / 1000.0)) << "\n";
+    return 0;
+}
@@ -0,0 +1,68 @@
+// Resident memory of a synthetic store: transactions plus the per-buyer order
+// lists, per-seller sale lists and the two bank rows each purchase leaves behind.
+// Usage: bench_memory [transactions] [buyers] [sellers] [items]
+
+#include "bench_util.h"
+#include "bank.h"
+#include "store.h"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+static long procStatusKB(const char* field) {
+    std::ifstream f("/proc/self/status");
+    std::string line;
+    while (std::getline(f, line)) {
+        if (line.compare(0, std::string(field).size(), field) == 0) return std::atol(line.c_str() + std::string(field).size() + 1);
+    }
+    return -1;
+}
+
+int main(int argc, char** argv) {
+    long txs = argc > 1 ? std::atol(argv[1]) : 10000000;
+    long buyers = argc > 2 ? std::atol(argv[2]) : 100000;
+    long sellers = argc > 3 ? std::atol(argv[3]) : 5000;
+    long items = argc > 4 ? std::atol(argv[4]) : 200000;
+
+    long baseKB = procStatusKB("VmRSS:");
+    Bank bank;
+    Store store;
+    store.setBank(&bank);
+    for (long s = 0; s < sellers; ++s) {
+        std::string sid = bench::numberedID("S", s);
+        store.registerSeller(sid, sid, "pw");
+    }
+    for (long i = 0; i < items; ++i)
+        store.addItem(bench::numberedID("S", i % sellers), bench::numberedID("I", i), "Item name " + std::to_string(i), Money::units(1), 1000);
+    for (long b = 0; b < buyers; ++b) {
+        std::string bid = bench::numberedID("B", b);
+        store.registerBuyer(bid, bid, "pw");
+    }
+    long usersKB = procStatusKB("VmRSS:");
+
+    Date today = Date::today();
+    bench::Timer t;
+    for (long n = 0; n < txs; ++n) {
+        Sym tid(store.genID("TX"));
+        std::string bid = bench::numberedID("B", n % buyers);
+        long item = (n * 7919) % items;
+        std::string iid = bench::numberedID("I", item);
+        std::string sid = bench::numberedID("S", item % sellers);
+        Date d = today - (int)(n % 365);
+        store.transactions[tid] = Transaction(tid, d, bid, sid, iid, "Item name " + std::to_string(item),
+                                              1, Money::units(1), TransactionStatus::PAID);
+        store.buyers[bid].orderIDs.push_back(tid);
+        store.sellers[sid].saleTxIDs.push_back(tid);
+        bank.getAccount(bid)->withdraw(Money(), d, "purchase " + iid);
+        bank.getAccount(sid)->deposit(Money(), d, "sale " + iid);
+    }
+    store.rebuildIndexes();
+    long endKB = procStatusKB("VmRSS:");
+
+    std::cout << "transactions=" << txs << " build_ms=" << t.elapsedMs()
+              << " rss_users_kb=" << usersKB - baseKB
+              << " rss_total_kb=" << endKB - baseKB
+              << " peak_kb=" << procStatusKB("VmHWM:")
+              << " bytes_per_tx=" << (endKB - usersKB) * 1024.0 / txs << "\n";
+    return 0;
+}
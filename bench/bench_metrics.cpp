@@ -0,0 +1,86 @@
+// Measures the cost of the operation metrics (metrics.h) and checks what they report.
+// Build it twice, as usual and with -DSTORE_NO_METRICS, and compare the purchase and
+// login timings: the difference is the instrumentation overhead on those paths.
+
+#include "bench_util.h"
+#include "bank.h"
+#include "metrics.h"
+#include "store.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+int main() {
+#ifdef STORE_NO_METRICS
+    std::cout << "metrics: compiled out\n";
+#else
+    std::cout << "metrics: on\n";
+#endif
+
+    // raw recording cost
+    const int kRecords = 5000000;
+    Histogram h;
+    std::mt19937_64 rng(7);
+    std::lognormal_distribution<double> dist(8.0, 1.5); // ~3 us median, long tail
+    std::vector<uint64_t> samples(kRecords);
+    for (auto &s : samples) s = (uint64_t)dist(rng);
+    bench::Timer t;
+    for (uint64_t s : samples) h.record(s);
+    std::cout << "Histogram::record avg_ns=" << t.elapsedNs() / kRecords << "\n";
+    t.reset();
+    for (int i = 0; i < kRecords; ++i) OpTimer scope(Op::LIST_ITEMS);
+    std::cout << "OpTimer empty scope avg_ns=" << t.elapsedNs() / kRecords << "\n";
+
+    // percentile error against the exact order statistics
+    std::vector<uint64_t> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+    for (double q : {0.5, 0.9, 0.99, 0.999}) {
+        uint64_t exact = sorted[(size_t)(q * (sorted.size() - 1))];
+        uint64_t got = h.percentile(q);
+        std::printf("p%-5g exact_ns=%-8llu histogram_ns=%-8llu error=%.2f%%\n", q * 100, (unsigned long long)exact,
+                    (unsigned long long)got, 100.0 * ((double)got - (double)exact) / (double)exact);
+    }
+
+    // hot paths with metrics on (or compiled out)
+    Bank bank;
+    Store store;
+    store.setBank(&bank);
+    Date d = Date::today();
+    const int kItems = 10000, kPurchases = 200000;
+    store.registerSeller("S0", "seller0", "pw");
+    for (int i = 0; i < kItems; ++i) store.addItem("S0", bench::numberedID("I", i), "item", Money::units(1), kPurchases);
+    store.registerBuyer("B0", "buyer0", "pw");
+    bank.deposit("B0", Money::units(1000000000), d, "bench");
+    metrics().reset();
+
+    std::vector<std::string> targets;
+    std::uniform_int_distribution<int> pick(0, kItems - 1);
+    for (int i = 0; i < kPurchases; ++i) targets.push_back(bench::numberedID("I", pick(rng)));
+    t.reset();
+    for (auto &iid : targets) store.purchase("B0", iid, 1, d);
+    std::cout << "purchase avg_ns=" << t.elapsedNs() / kPurchases << "\n";
+    t.reset();
+    for (int i = 0; i < kPurchases; ++i) store.login("seller0", "pw");
+    std::cout << "login avg_ns=" << t.elapsedNs() / kPurchases << "\n";
+
+    // failure reasons, counted apart
+    store.registerBuyer("B1", "poor", "pw"); // no funds
+    store.addItem("S0", "RARE", "rare", Money::units(1), 1);
+    store.purchase("B0", "RARE", 2, d);   // out_of_stock
+    store.purchase("B1", "I1", 1, d);     // insufficient_funds
+    store.purchase("NOBODY", "I1", 1, d); // unknown_buyer
+    store.purchase("B0", "NOTHING", 1, d); // unknown_item
+    store.purchase("B0", "I1", 0, d);     // invalid_qty
+    store.login("poor", "wrong");
+    store.login("ghost", "pw");
+
+    std::cout << "\nop|calls|failures|p50_us|p99_us|max_us|reasons\n";
+    for (auto &row : metrics().dump()) std::cout << row << "\n";
+    std::ostringstream prom;
+    metrics().writePrometheus(prom);
+    std::cout << "prometheus export: " << prom.str().size() << " bytes\n";
+    return 0;
+}
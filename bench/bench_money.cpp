@@ -0,0 +1,100 @@
+// Money (i64 cents) against the double amounts it replaced: exactness of sums and of
+// the text round-trip the old saveStore did (default stream precision), and the speed
+// of the inflow/outflow aggregate loop and of text formatting/parsing.
+// Usage: bench_money [amounts]
+
+#include "bench_util.h"
+#include "money.h"
+#include <charconv>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+template <class T> static void inOut(const std::vector<T>& v, T& in, T& out) {
+    // the shape of BankAccount::summary's window sums
+    for (const T& a : v) {
+        if (a >= T()) in += a;
+        else out -= a;
+    }
+}
+
+int main(int argc, char** argv) {
+    long n = argc > 1 ? std::atol(argv[1]) : 2000000;
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int64_t> pick(-999999, 999999); // -9999.99 .. 9999.99
+    std::vector<int64_t> cents(n);
+    std::vector<double> dbl(n);
+    std::vector<Money> money(n);
+    int64_t exact = 0;
+    for (long i = 0; i < n; ++i) {
+        cents[i] = pick(rng);
+        dbl[i] = cents[i] / 100.0;
+        money[i] = Money(cents[i]);
+        exact += cents[i];
+    }
+
+    // exactness
+    double dsum = 0;
+    Money msum;
+    for (long i = 0; i < n; ++i) { dsum += dbl[i]; msum += money[i]; }
+    // balances grow past the 6 significant digits a default stream prints
+    std::uniform_int_distribution<int64_t> pickBalance(0, 10000000000LL); // up to 100M units
+    long dLost = 0, mLost = 0;
+    for (long i = 0; i < n; ++i) {
+        int64_t b = pickBalance(rng);
+        std::ostringstream ss;
+        ss << b / 100.0;
+        if (std::llround(std::stod(ss.str()) * 100) != b) ++dLost;
+        if (Money::parse(Money(b).str()) != Money(b)) ++mLost;
+    }
+    std::cout << "sum: exact=" << Money(exact) << " double=" << Money::fromDouble(dsum)
+              << " (off by " << (Money::fromDouble(dsum) - Money(exact)).cents << " cents, raw "
+              << dsum - exact / 100.0 << ") money=" << msum << "\n";
+    std::cout << "balance text round-trip mismatches: double=" << dLost << "/" << n
+              << " money=" << mLost << "/" << n << "\n";
+
+    // aggregate loop
+    const int reps = 20;
+    bench::Timer t;
+    double din = 0, dout = 0;
+    for (int r = 0; r < reps; ++r) inOut(dbl, din, dout);
+    double dNs = t.elapsedNs() / (double(n) * reps);
+    t.reset();
+    Money min, mout;
+    for (int r = 0; r < reps; ++r) inOut(money, min, mout);
+    double mNs = t.elapsedNs() / (double(n) * reps);
+    std::cout << "in/out aggregate: double " << dNs << " ns/amount, money " << mNs << " ns/amount"
+              << " (double drift after " << reps << " passes: "
+              << (Money::fromDouble(din) - min).cents << " cents)\n";
+
+    // formatting and parsing
+    std::vector<std::string> dText(n), mText(n);
+    t.reset();
+    for (long i = 0; i < n; ++i) { std::ostringstream ss; ss << dbl[i]; dText[i] = ss.str(); }
+    double dFmt = t.elapsedNs() / n;
+    t.reset();
+    for (long i = 0; i < n; ++i) mText[i] = money[i].str();
+    double mFmt = t.elapsedNs() / n;
+    double dAcc = 0;
+    t.reset();
+    for (long i = 0; i < n; ++i) {
+        double v = 0;
+        std::from_chars(dText[i].data(), dText[i].data() + dText[i].size(), v);
+        dAcc += v;
+    }
+    double dParse = t.elapsedNs() / n;
+    Money mAcc;
+    t.reset();
+    for (long i = 0; i < n; ++i) {
+        Money v;
+        Money::tryParse(mText[i].data(), mText[i].size(), v);
+        mAcc += v;
+    }
+    double mParse = t.elapsedNs() / n;
+    std::cout << "format: double(ostream) " << dFmt << " ns, money " << mFmt << " ns\n";
+    std::cout << "parse: double(from_chars) " << dParse << " ns, money " << mParse << " ns"
+              << " (check " << (mAcc == msum) << " " << (dAcc != 0) << ")\n";
+    return 0;
+}
@@ -0,0 +1,74 @@
+// Report APIs that return a vector of copies against the paged visitor forms:
+// heap allocations, time until the first row is available, and total time.
+// Usage: bench_paged [transactions] [pageSize]
+
+#include "bench_util.h"
+#include "alloc_counter.h"
+#include "bank.h"
+#include "store.h"
+#include <cstdlib>
+#include <iostream>
+
+static void report(const char* name, size_t rows, long allocs, double firstMs, double totalMs) {
+    std::cout << name << ": rows=" << rows << " allocs=" << allocs
+              << " first_row_ms=" << firstMs << " total_ms=" << totalMs << "\n";
+}
+
+template <class Call> static void measureVector(const char* name, Call call) {
+    long before = bench::allocs.load();
+    bench::Timer t;
+    size_t rows = call().size();
+    double ms = t.elapsedMs();
+    report(name, rows, bench::allocs.load() - before, ms, ms);
+}
+
+// page(token, limit, onRow) -> next token
+template <class Page> static void measurePaged(const char* name, size_t pageSize, Page page) {
+    long before = bench::allocs.load();
+    bench::Timer t;
+    double first = -1;
+    size_t rows = 0;
+    std::string token;
+    do {
+        token = page(token, pageSize, [&]() {
+            if (rows++ == 0) first = t.elapsedMs();
+        });
+    } while (!token.empty());
+    report(name, rows, bench::allocs.load() - before, first, t.elapsedMs());
+}
+
+int main(int argc, char** argv) {
+    long txs = argc > 1 ? std::atol(argv[1]) : 1000000;
+    size_t pageSize = argc > 2 ? std::atol(argv[2]) : 1000;
+    Bank bank;
+    Store store;
+    store.setBank(&bank);
+    Date today = Date::today();
+    for (long i = 0; i < txs; ++i) {
+        Sym tid(store.genID("TX"));
+        store.transactions[tid] = Transaction(tid, today - (int)(i % 30), bench::numberedID("B", i % 20000),
+                                              bench::numberedID("S", i % 500), bench::numberedID("I", i % 50000),
+                                              "Item name", 1, Money::units(1),
+                                              i % 2 ? TransactionStatus::COMPLETED : TransactionStatus::PAID);
+    }
+    for (long a = 0; a < txs / 10; ++a) {
+        std::string id = bench::numberedID("A", a);
+        bank.createAccount(id, "owner " + id);
+        for (int k = 13; k >= 0; --k) bank.deposit(id, Money::units(1), today - k, "topup");
+    }
+    store.rebuildIndexes();
+
+    measureVector("listTransactionsLastKDays(7)  vector", [&]() { return store.listTransactionsLastKDays(7); });
+    measurePaged("visitTransactionsLastKDays(7) paged ", pageSize, [&](const std::string& tok, size_t n, auto onRow) {
+        return store.visitTransactionsLastKDays(7, tok, n, [&](const Transaction&) { onRow(); });
+    });
+    measureVector("listPaidNotCompleted          vector", [&]() { return store.listPaidNotCompleted(); });
+    measurePaged("visitPaidNotCompleted         paged ", pageSize, [&](const std::string& tok, size_t n, auto onRow) {
+        return store.visitPaidNotCompleted(tok, n, [&](const Transaction&) { onRow(); });
+    });
+    measureVector("transactionsLastWeek          vector", [&]() { return bank.transactionsLastWeek(); });
+    measurePaged("visitTransactionsLastWeek     paged ", pageSize, [&](const std::string& tok, size_t n, auto onRow) {
+        return bank.visitTransactionsLastWeek(tok, n, [&](const BankAccount&, const BankTx&) { onRow(); });
+    });
+    return 0;
+}
@@ -0,0 +1,48 @@
+// Measures Store::purchase latency as the catalog grows.
+// Every seller owns itemsPerSeller items; purchases target items spread over the whole catalog.
+
+#include "bench_util.h"
+#include "bank.h"
+#include "store.h"
+#include <iostream>
+#include <random>
+
+static void run(int sellers, int itemsPerSeller, int purchases) {
+    Bank bank;
+    Store store;
+    store.setBank(&bank);
+    Date d = Date::today();
+
+    for (int s = 0; s < sellers; ++s) {
+        std::string sid = bench::numberedID("S", s);
+        store.registerSeller(sid, sid, "pw");
+        for (int i = 0; i < itemsPerSeller; ++i) {
+            std::string iid = bench::numberedID("I", (long)s * itemsPerSeller + i);
+            store.addItem(sid, iid, iid, Money::units(1), purchases);
+        }
+    }
+    store.registerBuyer("B0", "buyer0", "pw");
+    bank.deposit("B0", Money::units(1000000000000), d, "bench");
+
+    long catalog = (long)sellers * itemsPerSeller;
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<long> pick(0, catalog - 1);
+    std::vector<std::string> targets;
+    targets.reserve(purchases);
+    for (int i = 0; i < purchases; ++i) targets.push_back(bench::numberedID("I", pick(rng)));
+
+    bench::Timer t;
+    int ok = 0;
+    for (auto &iid : targets) ok += store.purchase("B0", iid, 1, d);
+    double ns = t.elapsedNs();
+
+    std::cout << "sellers=" << sellers << " items=" << catalog
+              << " purchases=" << ok << "/" << purchases
+              << " avg_ns=" << (long)(ns / purchases) << "\n";
+}
+
+int main() {
+    int purchases = 5000;
+    for (int sellers : {10, 100, 1000, 10000}) run(sellers, 10, purchases);
+    return 0;
+}
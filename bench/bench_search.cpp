@@ -0,0 +1,241 @@
+// Catalog search (Store::searchItems) query latency against a full scan of Store::items,
+// plus a check that paged results equal a brute-force scan, before and after a burst of
+// purchases, cancels, price changes, replenishes and discards.
+// Names are three words drawn Zipf-skewed from a 20000-word vocabulary plus a model word.
+// Usage: bench_search [ITEMS]   (default 1000000)
+
+#include "bench_util.h"
+#include "bank.h"
+#include "store.h"
+#include "zipf.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+
+const int kVocabulary = 20000;
+
+// zero-padded, so ID order is also the order items were added (= catalog order, before and after a reload)
+std::string itemID(long n) {
+    char buf[32];
+    std::snprintf(buf, sizeof buf, "I%08ld", n);
+    return buf;
+}
+
+void fill(Store& store, Bank& bank, long items, std::mt19937_64& rng) {
+    bench::Zipf word(kVocabulary, 1.0);
+    std::uniform_int_distribution<int> cents(100, 100000), units(1, 100), pct(0, 99);
+    int sellers = 1000;
+    for (int s = 0; s < sellers; ++s) {
+        std::string sid = bench::numberedID("S", s);
+        store.registerSeller(sid, sid, "pw");
+    }
+    for (long i = 0; i < items; ++i) {
+        std::string name = "w" + std::to_string(word(rng)) + " w" + std::to_string(word(rng)) + " w" +
+                           std::to_string(word(rng)) + " m" + std::to_string(i % 100000);
+        store.addItem(bench::numberedID("S", i % sellers), itemID(i), name, Money(cents(rng)),
+                      pct(rng) < 20 ? 0 : units(rng));
+    }
+    store.registerBuyer("B0", "b0", "pw");
+    bank.deposit("B0", Money::units(1000000000), Date::today(), "bench");
+}
+
+// every page of q through searchItems, as item IDs
+std::vector<std::string> paged(const Store& store, const CatalogIndex::Query& q, size_t limit) {
+    std::vector<std::string> ids;
+    std::vector<Item> page;
+    std::string token;
+    do {
+        token = store.searchItems(q, token, limit, page);
+        for (auto &i : page) ids.push_back(i.itemID);
+    } while (!token.empty());
+    return ids;
+}
+
+// the same answer from a scan of every item
+std::vector<std::string> scan(const Store& store, const CatalogIndex::Query& q) {
+    auto want = CatalogIndex::words(q.text);
+    std::vector<const Item*> hits;
+    for (auto &p : store.items) {
+        const Item &i = p.second;
+        if (i.price < q.minPrice || i.price > q.maxPrice || i.stock < q.minStock) continue;
+        auto have = CatalogIndex::words(i.name);
+        bool all = true;
+        for (auto &w : want) all = all && std::find(have.begin(), have.end(), w) != have.end();
+        if (all) hits.push_back(&i);
+    }
+    // hits are in ID order, which is catalog order
+    if (q.order == CatalogIndex::Order::PRICE_ASC)
+        std::stable_sort(hits.begin(), hits.end(), [](const Item* a, const Item* b) { return a->price < b->price; });
+    else if (q.order == CatalogIndex::Order::PRICE_DESC)
+        std::sort(hits.begin(), hits.end(), [](const Item* a, const Item* b) {
+            return a->price != b->price ? b->price < a->price : a->itemID > b->itemID;
+        });
+    std::vector<std::string> ids;
+    for (auto *i : hits) ids.push_back(i->itemID);
+    return ids;
+}
+
+CatalogIndex::Query randomQuery(std::mt19937_64& rng) {
+    static const char* texts[] = {"", "w0", "w1", "w5", "w0 w1", "W3 w0", "w40", "w199 w0", "m7", "w0 m12", "nothing"};
+    static const CatalogIndex::Order orders[] = {CatalogIndex::Order::PRICE_ASC, CatalogIndex::Order::PRICE_DESC,
+                                                 CatalogIndex::Order::CATALOG};
+    CatalogIndex::Query q;
+    q.text = texts[rng() % (sizeof(texts) / sizeof(texts[0]))];
+    q.order = orders[rng() % 3];
+    if (rng() % 2) {
+        q.minPrice = Money(100 + (int64_t)(rng() % 50000));
+        q.maxPrice = q.minPrice + Money((int64_t)(rng() % 20000));
+    }
+    q.minStock = (int)(rng() % 3);
+    return q;
+}
+
+bool verify(Store& store, std::mt19937_64& rng, int queries) {
+    for (int i = 0; i < queries; ++i) {
+        CatalogIndex::Query q = randomQuery(rng);
+        size_t limit = 1 + rng() % 40;
+        if (paged(store, q, limit) != scan(store, q)) {
+            std::cout << "MISMATCH text='" << q.text << "' order=" << (int)q.order << " min=" << q.minPrice
+                      << " max=" << q.maxPrice << " stock=" << q.minStock << " limit=" << limit << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+void churn(Store& store, long items, int ops, std::mt19937_64& rng) {
+    Date d = Date::today();
+    std::vector<std::string> orders;
+    for (int i = 0; i < ops; ++i) {
+        long n = (long)(rng() % items);
+        std::string iid = itemID(n), sid = bench::numberedID("S", n % 1000);
+        switch (rng() % 6) {
+        case 0: case 1: {
+            std::string tid = store.genID("TX");
+            if (store.purchaseWithID(tid, "B0", iid, 1 + (int)(rng() % 3), d)) orders.push_back(tid);
+            break;
+        }
+        case 2: if (!orders.empty()) store.cancelTransaction("B0", orders[rng() % orders.size()], d); break;
+        case 3: store.setItemPrice(sid, iid, Money(100 + (int64_t)(rng() % 100000))); break;
+        case 4: store.replenishItem(sid, iid, (int)(rng() % 5)); break;
+        default: store.discardItem(sid, iid, (int)(rng() % 5)); break;
+        }
+    }
+    std::vector<PurchaseLine> cart;
+    for (int i = 0; i < 20; ++i) cart.push_back({"B0", itemID((long)(rng() % items)), 1});
+    store.purchaseBatch(cart, d);
+}
+
+struct Stats {
+    double p50, p99;
+};
+
+template <class F> Stats time(int reps, F&& f) {
+    std::vector<double> us;
+    for (int i = 0; i < reps; ++i) {
+        bench::Timer t;
+        f(i);
+        us.push_back(t.elapsedNs() / 1e3);
+    }
+    std::sort(us.begin(), us.end());
+    return {us[us.size() / 2], us[std::min(us.size() - 1, us.size() * 99 / 100)]};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    long items = argc > 1 ? std::atol(argv[1]) : 1000000;
+    std::mt19937_64 rng(11);
+
+    {
+        // correctness on a catalog the scan can afford
+        Bank bank;
+        Store store;
+        store.setBank(&bank);
+        long n = 20000;
+        fill(store, bank, n, rng);
+        bool ok = verify(store, rng, 300);
+        churn(store, n, 20000, rng);
+        ok = ok && verify(store, rng, 300);
+        store.rebuildIndexes(); // what a load does
+        ok = ok && verify(store, rng, 100);
+        std::cout << "verify items=" << n << " " << (ok ? "OK" : "FAILED") << "\n";
+        if (!ok) return 1;
+    }
+
+    Bank bank;
+    Store store;
+    store.setBank(&bank);
+    bench::Timer build;
+    fill(store, bank, items, rng);
+    std::cout << "items=" << items << " build_ms=" << (long)build.elapsedMs() << "\n";
+
+    struct Case {
+        const char* label;
+        CatalogIndex::Query q;
+        int pages; // page to time (1 = first)
+    };
+    auto query = [](const char* text, CatalogIndex::Order order, int64_t lo, int64_t hi, int stock) {
+        CatalogIndex::Query q;
+        q.text = text;
+        q.order = order;
+        q.minPrice = Money(lo);
+        if (hi > 0) q.maxPrice = Money(hi);
+        q.minStock = stock;
+        return q;
+    };
+    using O = CatalogIndex::Order;
+    std::vector<Case> cases = {
+        {"common word, by price", query("w0", O::PRICE_ASC, 0, 0, 0), 1},
+        {"common word, in stock, by price", query("w0", O::PRICE_ASC, 0, 0, 1), 1},
+        {"mid word (rank 100), by price", query("w100", O::PRICE_ASC, 0, 0, 0), 1},
+        {"rare word (rank 15000), by price", query("w15000", O::PRICE_ASC, 0, 0, 0), 1},
+        {"two words, by price desc", query("w0 w1", O::PRICE_DESC, 0, 0, 0), 1},
+        {"common word + price 10-20", query("w0", O::PRICE_ASC, 1000, 2000, 1), 1},
+        {"price 10-20 in stock only", query("", O::PRICE_ASC, 1000, 2000, 1), 1},
+        {"everything, by price desc", query("", O::PRICE_DESC, 0, 0, 0), 1},
+        {"common word, catalog order", query("w0", O::CATALOG, 0, 0, 0), 1},
+        {"common word, by price, page 50", query("w0", O::PRICE_ASC, 0, 0, 0), 50},
+        {"mid word, by price, page 50", query("w100", O::PRICE_ASC, 0, 0, 0), 50},
+    };
+    const size_t kPage = 20;
+    std::printf("%-36s %10s %10s %8s\n", "query (20 per page)", "p50_us", "p99_us", "rows");
+    for (auto &c : cases) {
+        std::vector<std::string> tokens(1); // token before each page
+        std::vector<Item> page;
+        for (int p = 1; p < c.pages; ++p) tokens.push_back(store.searchItems(c.q, tokens.back(), kPage, page));
+        size_t rows = 0;
+        Stats s = time(200, [&](int) { store.searchItems(c.q, tokens.back(), kPage, page); rows = page.size(); });
+        std::printf("%-36s %10.1f %10.1f %8zu\n", c.label, s.p50, s.p99, rows);
+    }
+
+    // the same first page without the index: tokenize and filter every name, keep the cheapest 20
+    Stats full = time(3, [&](int) {
+        auto want = CatalogIndex::words("w0 w1");
+        std::vector<std::pair<Money, const Item*>> hits;
+        for (auto &p : store.items) {
+            auto have = CatalogIndex::words(p.second.name);
+            bool all = true;
+            for (auto &w : want) all = all && std::find(have.begin(), have.end(), w) != have.end();
+            if (all) hits.emplace_back(p.second.price, &p.second);
+        }
+        size_t n = std::min(kPage, hits.size());
+        std::partial_sort(hits.begin(), hits.begin() + n, hits.end(),
+                          [](auto &a, auto &b) { return a.first < b.first; });
+    });
+    std::printf("%-36s %10.1f %10.1f\n", "full scan: two words, by price", full.p50, full.p99);
+
+    // what the index adds to the mutators
+    Date d = Date::today();
+    Stats price = time(20000, [&](int i) {
+        store.setItemPrice(bench::numberedID("S", i % 1000), itemID(i), Money(500 + i % 1000));
+    });
+    Stats buy = time(20000, [&](int i) { store.purchase("B0", itemID((long)i * 7 % items), 1, d); });
+    std::printf("setItemPrice p50_us=%.2f  purchase p50_us=%.2f\n", price.p50, buy.p50);
+    return 0;
+}
@@ -0,0 +1,31 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+// Small helpers shared by the benchmark programs in this folder.
+// Build a benchmark from the repo root, e.g.:
+//   g++ -std=c++17 -O2 -pthread -I. bench/bench_purchase.cpp bank.cpp catalog_index.cpp date.cpp dormancy_index.cpp leaderboard.cpp metrics.cpp models.cpp money.cpp store.cpp data_manager.cpp record_pool.cpp symbol.cpp tx_columns.cpp wal.cpp -o bench_purchase
+
+#include <chrono>
+#include <string>
+
+namespace bench {
+
+class Timer {
+public:
+    Timer() : start(std::chrono::steady_clock::now()) {}
+    void reset() { start = std::chrono::steady_clock::now(); }
+    double elapsedNs() const {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+    double elapsedMs() const { return elapsedNs() / 1e6; }
+private:
+    std::chrono::steady_clock::time_point start;
+};
+
+inline std::string numberedID(const std::string& prefix, long n) {
+    return prefix + std::to_string(n);
+}
+
+} // namespace bench
+
+#endif // BENCH_UTIL_H
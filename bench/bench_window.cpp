@@ -0,0 +1,70 @@
+// Time-window report queries: day-indexed Store functions vs. the old full scans.
+// Usage: bench_window [transactions] [days_of_history]
+
+#include "bench_util.h"
+#include "bank.h"
+#include "store.h"
+#include <cstdlib>
+#include <iostream>
+#include <map>
+
+// the pre-index implementations, kept here as the baseline
+static size_t scanLastKDays(const Store& store, int k) {
+    std::vector<Transaction> out;
+    Date t = Date::today();
+    for (auto &p : store.transactions) {
+        if (t - p.second.date <= k) out.push_back(p.second);
+    }
+    return out.size();
+}
+
+static size_t scanActiveBuyersToday(const Store& store) {
+    std::map<std::string,int> counts;
+    Date t = Date::today();
+    for (auto &p : store.transactions) {
+        if (p.second.date == t) counts[p.second.buyerID]++;
+    }
+    return counts.size();
+}
+
+int main(int argc, char** argv) {
+    long txs = argc > 1 ? std::atol(argv[1]) : 10000000;
+    int days = argc > 2 ? std::atoi(argv[2]) : 365;
+
+    Bank bank;
+    Store store;
+    store.setBank(&bank);
+    Date today = Date::today();
+    std::vector<Date> dates;
+    for (int d = 0; d < days; ++d) dates.push_back(today - d);
+
+    bench::Timer t;
+    for (long i = 0; i < txs; ++i) {
+        std::string tid = bench::numberedID("TX", i);
+        store.transactions[tid] = Transaction(tid, dates[i % days], bench::numberedID("B", i % 1000),
+                                              "S1", "I1", "Item", 1, Money::units(1), TransactionStatus::PAID);
+    }
+    store.rebuildIndexes();
+    std::cout << "built " << txs << " transactions over " << days << " days in " << t.elapsedMs() << " ms\n";
+
+    for (int k : {1, 7, 30}) {
+        t.reset();
+        size_t full = scanLastKDays(store, k);
+        double fullMs = t.elapsedMs();
+        t.reset();
+        size_t indexed = store.listTransactionsLastKDays(k).size();
+        double idxMs = t.elapsedMs();
+        std::cout << "last " << k << " days: rows=" << indexed << "/" << full
+                  << " full_scan_ms=" << fullMs << " indexed_ms=" << idxMs << "\n";
+    }
+
+    t.reset();
+    size_t full = scanActiveBuyersToday(store);
+    double fullMs = t.elapsedMs();
+    t.reset();
+    size_t indexed = store.mostActiveBuyersPerDay(1 << 30).size();
+    double idxMs = t.elapsedMs();
+    std::cout << "active buyers today: rows=" << indexed << "/" << full
+              << " full_scan_ms=" << fullMs << " indexed_ms=" << idxMs << "\n";
+    return 0;
+}
@@ -0,0 +1,207 @@
+// Synthetic workload: builds a population of buyers, sellers and items plus a purchase
+// history with Zipf-skewed popularity, then drives a weighted mix of every Store/Bank
+// operation and report. Per operation: count, throughput, p50/p99/max latency and the
+// growth of peak RSS while it ran; overall: setup time, throughput and peak RSS.
+// Usage: bench_workload [key=value ...]
+//   buyers=20000 sellers=500 items=20000 history=200000 days=60 ops=100000 zipf=1.0 seed=1
+//   mix=purchase:500,login:100,...   (weights, replacing the defaults of the named ops)
+//   json=PATH                        (also write the results as JSON; "-" prints only JSON)
+
+#include "bench_util.h"
+#include "zipf.h"
+#include "bank.h"
+#include "store.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <sys/resource.h>
+
+static long peakRssKb() {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_maxrss; // KB on Linux
+}
+
+struct Op {
+    Op(const char* n, double w, std::function<void()> f) : name(n), weight(w), run(std::move(f)) {}
+    std::string name;
+    double weight;
+    std::function<void()> run;
+    std::vector<double> ns;
+    long rssGrowthKb = 0; // peak RSS growth observed while this op ran
+};
+
+static double percentile(std::vector<double>& v, double p) {
+    if (v.empty()) return 0;
+    size_t k = std::min(v.size() - 1, (size_t)(p * v.size()));
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+int main(int argc, char** argv) {
+    std::map<std::string, std::string> cfg = {
+        {"buyers", "20000"}, {"sellers", "500"}, {"items", "20000"}, {"history", "200000"},
+        {"days", "60"}, {"ops", "100000"}, {"zipf", "1.0"}, {"seed", "1"}, {"mix", ""}, {"json", ""}};
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        size_t eq = a.find('=');
+        if (eq == std::string::npos || !cfg.count(a.substr(0, eq))) {
+            std::cerr << "unknown argument: " << a << "\n";
+            return 2;
+        }
+        cfg[a.substr(0, eq)] = a.substr(eq + 1);
+    }
+    long nBuyers = std::atol(cfg["buyers"].c_str()), nSellers = std::atol(cfg["sellers"].c_str());
+    long nItems = std::atol(cfg["items"].c_str()), nHistory = std::atol(cfg["history"].c_str());
+    int days = std::atoi(cfg["days"].c_str());
+    long nOps = std::atol(cfg["ops"].c_str());
+    double s = std::atof(cfg["zipf"].c_str());
+    std::mt19937_64 rng(std::atol(cfg["seed"].c_str()));
+    bench::Zipf buyerPop(nBuyers, s), sellerPop(nSellers, s), itemPop(nItems, s);
+    auto buyerID = [](long i) { return bench::numberedID("B", i); };
+    auto sellerID = [](long i) { return bench::numberedID("S", i); };
+    auto itemID = [](long i) { return bench::numberedID("I", i); };
+
+    Bank bank;
+    Store store;
+    store.setBank(&bank);
+    Date today = Date::today();
+
+    // the mix (ops run against the population built below); weights are per ~1000 ops, whole-table reports are rare
+    std::vector<Op> ops = {
+        {"login", 100, [&]() { long b = buyerPop(rng); store.login("buyer" + std::to_string(b), "pw"); }},
+        {"purchase", 450, [&]() {
+            store.purchase(buyerID(buyerPop(rng)), itemID(itemPop(rng)), 1 + (int)(rng() % 3), today);
+        }},
+        {"deposit", 80, [&]() { bank.deposit(buyerID(buyerPop(rng)), Money(2500), today, "topup"); }},
+        {"withdraw", 40, [&]() { bank.withdraw(buyerID(buyerPop(rng)), Money(1000), today, "withdraw"); }},
+        {"complete_pending", 80, [&]() { store.completePending(sellerID(sellerPop(rng)), 1); }},
+        {"cancel", 20, [&]() { // the buyer's latest order
+            std::string b = buyerID(buyerPop(rng));
+            auto &orders = store.buyers.find(b)->second.orderIDs;
+            if (!orders.empty()) store.cancelTransaction(b, orders.back(), today);
+        }},
+        {"next_pending", 40, [&]() {
+            Transaction t;
+            store.nextPending(sellerID(sellerPop(rng)), t);
+        }},
+        {"spending_30d", 40, [&]() { store.spendingLastKDays(buyerID(buyerPop(rng)), 30); }},
+        {"most_frequent_items", 10, [&]() { store.mostFrequentItems(10); }},
+        {"active_buyers_today", 10, [&]() { store.mostActiveBuyersPerDay(10); }},
+        {"active_sellers_today", 10, [&]() { store.mostActiveSellersPerDay(10); }},
+        {"top_active_accounts", 10, [&]() { bank.topNActiveToday(10); }},
+        {"tx_last_7d_page", 5, [&]() { store.visitTransactionsLastKDays(7, "", 100, [](const Transaction&) {}); }},
+        {"paid_page", 5, [&]() { store.visitPaidNotCompleted("", 100, [](const Transaction&) {}); }},
+        {"dormant_page", 5, [&]() { bank.dormantPage(7, DormancyIndex::Entry(), 100); }},
+        {"bank_last_week_page", 5, [&]() {
+            bank.visitTransactionsLastWeek("", 100, [](const BankAccount&, const BankTx&) {});
+        }},
+        {"tx_last_7d", 0.2, [&]() { store.listTransactionsLastKDays(7); }},
+        {"paid_not_completed", 0.2, [&]() { store.listPaidNotCompleted(); }},
+        {"customers", 0.2, [&]() { bank.listCustomers(); }},
+        {"bank_last_week", 0.2, [&]() { bank.transactionsLastWeek(); }},
+        {"dormant_30d", 0.2, [&]() { bank.dormantAccounts(30); }},
+        {"account_summaries", 0.2, [&]() { bank.accountSummaries(); }},
+    };
+    std::stringstream mix(cfg["mix"]);
+    for (std::string part; std::getline(mix, part, ',');) {
+        size_t colon = part.find(':');
+        auto op = std::find_if(ops.begin(), ops.end(), [&](const Op& o) { return o.name == part.substr(0, colon); });
+        if (colon == std::string::npos || op == ops.end()) {
+            std::cerr << "bad mix entry: " << part << "\n";
+            return 2;
+        }
+        op->weight = std::atof(part.c_str() + colon + 1);
+    }
+    std::vector<double> weights;
+    for (auto &o : ops) weights.push_back(o.weight);
+    std::discrete_distribution<size_t> pickOp(weights.begin(), weights.end());
+
+    // population and history
+    bench::Timer setup;
+    for (long i = 0; i < nSellers; ++i) store.registerSeller(sellerID(i), "seller" + std::to_string(i), "pw");
+    for (long i = 0; i < nItems; ++i)
+        store.addItem(sellerID(i % nSellers), itemID(i), "Item " + std::to_string(i),
+                      Money(100 + (int64_t)(rng() % 10000)), 1 << 30);
+    for (long i = 0; i < nBuyers; ++i) {
+        store.registerBuyer(buyerID(i), "buyer" + std::to_string(i), "pw");
+        bank.deposit(buyerID(i), Money::units(1000000), today - days, "seed");
+    }
+    for (long i = 0; i < nHistory; ++i)
+        store.purchase(buyerID(buyerPop(rng)), itemID(itemPop(rng)), 1 + (int)(rng() % 3),
+                       today - (int)(days - 1 - i * days / std::max(1L, nHistory))); // oldest first
+    double setupMs = setup.elapsedMs();
+    long setupRss = peakRssKb();
+
+    bench::Timer wall;
+    for (long n = 0; n < nOps; ++n) {
+        Op &op = ops[pickOp(rng)];
+        long rssBefore = peakRssKb();
+        bench::Timer t;
+        op.run();
+        op.ns.push_back(t.elapsedNs());
+        op.rssGrowthKb += peakRssKb() - rssBefore;
+    }
+    double wallMs = wall.elapsedMs();
+    long peakRss = peakRssKb();
+
+    // report
+    std::ostringstream json, text;
+    json << "{\"config\":{";
+    bool first = true;
+    for (auto &kv : cfg) {
+        if (kv.first == "json") continue;
+        json << (first ? "" : ",") << "\"" << kv.first << "\":\"" << kv.second << "\"";
+        first = false;
+    }
+    json << "},\"setup_ms\":" << setupMs << ",\"setup_peak_rss_kb\":" << setupRss
+         << ",\"ops\":" << nOps << ",\"wall_ms\":" << wallMs
+         << ",\"ops_per_sec\":" << (long)(nOps / (wallMs / 1000.0)) << ",\"peak_rss_kb\":" << peakRss
+         << ",\"operations\":[";
+    text << "setup: " << setupMs << " ms, peak RSS " << setupRss << " KB\n"
+         << "mixed: " << nOps << " ops in " << wallMs << " ms (" << (long)(nOps / (wallMs / 1000.0))
+         << " ops/s), peak RSS " << peakRss << " KB\n";
+    char line[256];
+    std::snprintf(line, sizeof line, "%-22s %8s %12s %12s %12s %12s %8s\n",
+                  "op", "count", "ops/s", "p50_ns", "p99_ns", "max_ns", "rss_kb");
+    text << line;
+    first = true;
+    for (auto &o : ops) {
+        if (o.ns.empty()) continue;
+        double total = 0;
+        for (double v : o.ns) total += v;
+        double p50 = percentile(o.ns, 0.50), p99 = percentile(o.ns, 0.99);
+        double mx = *std::max_element(o.ns.begin(), o.ns.end());
+        long perSec = (long)(o.ns.size() / (total / 1e9));
+        json << (first ? "" : ",") << "{\"name\":\"" << o.name << "\",\"count\":" << o.ns.size()
+             << ",\"ops_per_sec\":" << perSec << ",\"p50_ns\":" << (long)p50 << ",\"p99_ns\":" << (long)p99
+             << ",\"max_ns\":" << (long)mx << ",\"rss_growth_kb\":" << o.rssGrowthKb << "}";
+        first = false;
+        std::snprintf(line, sizeof line, "%-22s %8zu %12ld %12ld %12ld %12ld %8ld\n", o.name.c_str(),
+                      o.ns.size(), perSec, (long)p50, (long)p99, (long)mx, o.rssGrowthKb);
+        text << line;
+    }
+    json << "]}\n";
+
+    const std::string &out = cfg["json"];
+    if (out == "-") {
+        std::cout << json.str();
+    } else {
+        std::cout << text.str();
+        if (!out.empty()) {
+            std::ofstream f(out);
+            f << json.str();
+            if (!f) {
+                std::cerr << "cannot write " << out << "\n";
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
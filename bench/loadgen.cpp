@@ -0,0 +1,272 @@
+// Load generator for `main --serve`: several connections, each keeping `depth` pipelined
+// requests in flight, drawn from a weighted mix over a Zipf-skewed population that it
+// registers first. Reports requests/sec and latency percentiles, overall and per command.
+// Build: g++ -std=c++17 -O2 -pthread -I. bench/loadgen.cpp -o loadgen
+// Usage: loadgen [key=value ...]
+//   addr=127.0.0.1:7411 (or unix:PATH) conns=8 depth=16 seconds=10 setup=1
+//   buyers=2000 sellers=50 items=2000 zipf=1.0 seed=1 json=PATH|-
+
+#include "bench_util.h"
+#include "zipf.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <random>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+int connectTo(const std::string& addr) {
+    if (addr.compare(0, 5, "unix:") == 0) {
+        sockaddr_un sa{};
+        sa.sun_family = AF_UNIX;
+        std::snprintf(sa.sun_path, sizeof(sa.sun_path), "%s", addr.c_str() + 5);
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, (sockaddr*)&sa, sizeof(sa)) == 0) return fd;
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    size_t colon = addr.rfind(':');
+    std::string host = colon == std::string::npos ? "127.0.0.1" : addr.substr(0, colon);
+    sockaddr_in sa{};
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons((uint16_t)std::atoi(addr.c_str() + (colon == std::string::npos ? 0 : colon + 1)));
+    if (inet_pton(AF_INET, host.c_str(), &sa.sin_addr) != 1) return -1;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    if (fd >= 0) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (fd >= 0 && connect(fd, (sockaddr*)&sa, sizeof(sa)) == 0) return fd;
+    if (fd >= 0) close(fd);
+    return -1;
+}
+
+// Blocking line-oriented connection.
+class Client {
+public:
+    explicit Client(int f) : fd(f) {}
+    ~Client() { if (fd >= 0) close(fd); }
+    bool send(const std::string& s) {
+        for (size_t off = 0; off < s.size();) {
+            ssize_t n = ::write(fd, s.data() + off, s.size() - off);
+            if (n <= 0) return false;
+            off += n;
+        }
+        return true;
+    }
+    bool readLine(std::string& line) {
+        for (;;) {
+            size_t nl = buf.find('\n', pos);
+            if (nl != std::string::npos) {
+                line.assign(buf, pos, nl - pos);
+                pos = nl + 1;
+                return true;
+            }
+            buf.erase(0, pos);
+            pos = 0;
+            char tmp[1 << 16];
+            ssize_t n = ::read(fd, tmp, sizeof(tmp));
+            if (n <= 0) return false;
+            buf.append(tmp, n);
+        }
+    }
+    // one response; commands answering rows send "ok <n>" and then n lines
+    bool readResponse(bool rows, bool& ok) {
+        std::string line;
+        if (!readLine(line)) return false;
+        ok = line.compare(0, 2, "ok") == 0;
+        long n = rows && ok ? std::atol(line.c_str() + 3) : 0;
+        for (long i = 0; i < n; ++i)
+            if (!readLine(line)) return false;
+        return true;
+    }
+
+private:
+    int fd;
+    std::string buf;
+    size_t pos = 0;
+};
+
+struct Cmd {
+    const char* name;
+    double weight;
+    bool rows;
+};
+
+struct Sample {
+    uint8_t cmd;
+    bool ok;
+    float us;
+};
+
+double percentile(std::vector<float>& v, double p) {
+    if (v.empty()) return 0;
+    size_t k = std::min(v.size() - 1, (size_t)(p * v.size()));
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::map<std::string, std::string> cfg = {
+        {"addr", "127.0.0.1:7411"}, {"conns", "8"}, {"depth", "16"}, {"seconds", "10"}, {"setup", "1"},
+        {"buyers", "2000"}, {"sellers", "50"}, {"items", "2000"}, {"zipf", "1.0"}, {"seed", "1"}, {"json", ""}};
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        size_t eq = a.find('=');
+        if (eq == std::string::npos || !cfg.count(a.substr(0, eq))) {
+            std::cerr << "unknown argument: " << a << "\n";
+            return 2;
+        }
+        cfg[a.substr(0, eq)] = a.substr(eq + 1);
+    }
+    const std::string addr = cfg["addr"];
+    int conns = std::atoi(cfg["conns"].c_str()), depth = std::max(1, std::atoi(cfg["depth"].c_str()));
+    double seconds = std::atof(cfg["seconds"].c_str());
+    long nBuyers = std::atol(cfg["buyers"].c_str()), nSellers = std::atol(cfg["sellers"].c_str());
+    long nItems = std::atol(cfg["items"].c_str());
+    double s = std::atof(cfg["zipf"].c_str());
+    long seed = std::atol(cfg["seed"].c_str());
+
+    if (cfg["setup"] != "0") {
+        // registrations may already exist from an earlier run; their errors are fine
+        std::ostringstream req;
+        long n = 0;
+        for (long i = 0; i < nSellers; ++i, ++n) req << "register_seller LGS" << i << " lgs" << i << " pw\n";
+        for (long i = 0; i < nItems; ++i, ++n)
+            req << "add_item LGS" << i % nSellers << " LGI" << i << " " << 1 + i % 50 << ".99 1000000000 Item " << i << "\n";
+        for (long i = 0; i < nBuyers; ++i, n += 2) req << "register_buyer LGB" << i << " lgb" << i << " pw\ntopup LGB" << i << " 100000000\n";
+        int fd = connectTo(addr);
+        if (fd < 0) {
+            std::cerr << "cannot connect to " << addr << "\n";
+            return 1;
+        }
+        Client c(fd);
+        bench::Timer t;
+        bool ok;
+        if (!c.send(req.str())) return 1;
+        for (long i = 0; i < n; ++i)
+            if (!c.readResponse(false, ok)) return 1;
+        std::cout << "setup: " << n << " requests in " << t.elapsedMs() << " ms\n";
+    }
+
+    const std::vector<Cmd> cmds = {
+        {"purchase", 50, false}, {"topup", 15, false}, {"login", 15, false}, {"items", 5, true},
+        {"report_top_items", 5, true}, {"pending", 5, false}, {"complete_pending", 5, false}};
+    std::vector<std::vector<Sample>> samples(conns);
+    std::atomic<bool> failed{false};
+    auto worker = [&](int id) {
+        int fd = connectTo(addr);
+        if (fd < 0) { failed = true; return; }
+        Client c(fd);
+        std::mt19937_64 rng(seed * 1000 + id);
+        bench::Zipf buyers(nBuyers, s), sellers(nSellers, s), items(nItems, s);
+        std::vector<double> w;
+        for (auto &cmd : cmds) w.push_back(cmd.weight);
+        std::discrete_distribution<int> pick(w.begin(), w.end());
+        struct InFlight { int cmd; std::chrono::steady_clock::time_point sent; };
+        std::deque<InFlight> inflight;
+        std::string batch;
+        auto& out = samples[id];
+        auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+        for (;;) {
+            bool running = std::chrono::steady_clock::now() < end;
+            if (!running && inflight.empty()) break;
+            batch.clear();
+            size_t queued = inflight.size();
+            while (running && (int)inflight.size() < depth) {
+                int k = pick(rng);
+                switch (k) {
+                case 0: batch += "purchase LGB" + std::to_string(buyers(rng)) + " LGI" + std::to_string(items(rng)) + " 1\n"; break;
+                case 1: batch += "topup LGB" + std::to_string(buyers(rng)) + " 25.50\n"; break;
+                case 2: batch += "login lgb" + std::to_string(buyers(rng)) + " pw\n"; break;
+                case 3: batch += "items 20 LGI" + std::to_string(items(rng)) + "\n"; break;
+                case 4: batch += "report top_items 10\n"; break;
+                case 5: batch += "pending LGS" + std::to_string(sellers(rng)) + "\n"; break;
+                default: batch += "complete_pending LGS" + std::to_string(sellers(rng)) + " 5\n"; break;
+                }
+                inflight.push_back({k, {}});
+            }
+            if (!batch.empty()) {
+                auto now = std::chrono::steady_clock::now();
+                for (size_t i = queued; i < inflight.size(); ++i) inflight[i].sent = now;
+                if (!c.send(batch)) { failed = true; return; }
+            }
+            bool ok;
+            if (!c.readResponse(cmds[inflight.front().cmd].rows, ok)) { failed = true; return; }
+            float us = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - inflight.front().sent).count();
+            out.push_back({(uint8_t)inflight.front().cmd, ok, us});
+            inflight.pop_front();
+        }
+    };
+    bench::Timer wall;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < conns; ++i) threads.emplace_back(worker, i);
+    for (auto &t : threads) t.join();
+    double wallMs = wall.elapsedMs();
+    if (failed) std::cerr << "warning: a connection failed before the end of the run\n";
+
+    // report
+    std::vector<float> all;
+    std::vector<std::vector<float>> per(cmds.size());
+    std::vector<long> errors(cmds.size());
+    for (auto &v : samples)
+        for (auto &x : v) {
+            all.push_back(x.us);
+            per[x.cmd].push_back(x.us);
+            errors[x.cmd] += !x.ok;
+        }
+    double rps = all.size() / (wallMs / 1000.0);
+    std::ostringstream json, text;
+    json << "{\"config\":{";
+    bool first = true;
+    for (auto &kv : cfg) {
+        if (kv.first == "json") continue;
+        json << (first ? "" : ",") << "\"" << kv.first << "\":\"" << kv.second << "\"";
+        first = false;
+    }
+    json << "},\"requests\":" << all.size() << ",\"wall_ms\":" << wallMs << ",\"requests_per_sec\":" << (long)rps
+         << ",\"p50_us\":" << percentile(all, 0.5) << ",\"p99_us\":" << percentile(all, 0.99)
+         << ",\"p999_us\":" << percentile(all, 0.999) << ",\"commands\":[";
+    text << all.size() << " requests in " << wallMs << " ms: " << (long)rps << " req/s, p50 "
+         << percentile(all, 0.5) << " us, p99 " << percentile(all, 0.99) << " us, p99.9 "
+         << percentile(all, 0.999) << " us\n";
+    char line[200];
+    std::snprintf(line, sizeof line, "%-18s %9s %8s %10s %10s %10s\n", "command", "count", "errors", "p50_us", "p99_us", "max_us");
+    text << line;
+    first = true;
+    for (size_t k = 0; k < cmds.size(); ++k) {
+        if (per[k].empty()) continue;
+        double p50 = percentile(per[k], 0.5), p99 = percentile(per[k], 0.99);
+        double mx = *std::max_element(per[k].begin(), per[k].end());
+        json << (first ? "" : ",") << "{\"name\":\"" << cmds[k].name << "\",\"count\":" << per[k].size()
+             << ",\"errors\":" << errors[k] << ",\"p50_us\":" << p50 << ",\"p99_us\":" << p99 << ",\"max_us\":" << mx << "}";
+        first = false;
+        std::snprintf(line, sizeof line, "%-18s %9zu %8ld %10.1f %10.1f %10.1f\n", cmds[k].name, per[k].size(),
+                      errors[k], p50, p99, mx);
+        text << line;
+    }
+    json << "]}\n";
+    const std::string &out = cfg["json"];
+    if (out == "-") {
+        std::cout << json.str();
+    } else {
+        std::cout << text.str();
+        if (!out.empty()) std::ofstream(out) << json.str();
+    }
+    return failed ? 1 : 0;
+}
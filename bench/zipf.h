@@ -0,0 +1,35 @@
+#ifndef ZIPF_H
+#define ZIPF_H
+
+// Zipf-distributed ranks 0..n-1: rank r is drawn with probability proportional to
+// 1/(r+1)^s, so a few IDs take most of the traffic (s=0 is uniform, ~1 is typical).
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+namespace bench {
+
+class Zipf {
+public:
+    Zipf(size_t n, double s) : cdf(n) {
+        double sum = 0;
+        for (size_t r = 0; r < n; ++r) cdf[r] = sum += 1.0 / std::pow(double(r + 1), s);
+        for (double &c : cdf) c /= sum;
+    }
+    template <class Rng> size_t operator()(Rng& rng) {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        size_t r = std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+        return r < cdf.size() ? r : cdf.size() - 1;
+    }
+    size_t size() const { return cdf.size(); }
+
+private:
+    std::vector<double> cdf;
+};
+
+} // namespace bench
+
+#endif // ZIPF_H
@@ -0,0 +1,157 @@
+#include "catalog_index.h"
+#include "models.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <functional>
+
+std::vector<std::string> CatalogIndex::words(std::string_view text) {
+    std::vector<std::string> out;
+    std::string w;
+    for (char ch : text) {
+        unsigned char c = (unsigned char)ch;
+        if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c >= 0x80) w += ch;
+        else if (c >= 'A' && c <= 'Z') w += char(c - 'A' + 'a');
+        else if (!w.empty()) out.push_back(std::move(w)), w.clear();
+    }
+    if (!w.empty()) out.push_back(std::move(w));
+    return out;
+}
+
+void CatalogIndex::add(const Item* item) {
+    if (docOf.count(item)) return;
+    Doc d = (Doc)items.size();
+    items.push_back(item);
+    cents.push_back(item->price.cents);
+    stock.push_back(item->stock);
+    docOf.emplace(item, d);
+    for (auto &w : words(item->name)) {
+        std::vector<Doc> &list = postings[w];
+        if (list.empty() || list.back() != d) list.push_back(d); // a word repeated in one name
+    }
+    byPrice.insert({item->price.cents, d});
+}
+
+void CatalogIndex::setPrice(const Item* item, Money price) {
+    auto it = docOf.find(item);
+    if (it == docOf.end() || cents[it->second] == price.cents) return;
+    Doc d = it->second;
+    byPrice.erase({cents[d], d});
+    cents[d] = price.cents;
+    byPrice.insert({price.cents, d});
+}
+
+void CatalogIndex::setStock(const Item* item, int s) {
+    auto it = docOf.find(item);
+    if (it != docOf.end()) stock[it->second].n.store(s, std::memory_order_relaxed);
+}
+
+void CatalogIndex::clear() {
+    items.clear();
+    cents.clear();
+    stock.clear();
+    docOf.clear();
+    postings.clear();
+    byPrice.clear();
+}
+
+bool CatalogIndex::matches(Doc d, const Query& q) const {
+    return cents[d] >= q.minPrice.cents && cents[d] <= q.maxPrice.cents && stock[d].get() >= q.minStock;
+}
+
+bool CatalogIndex::inAll(Doc d, const std::vector<const std::vector<Doc>*>& lists, size_t skip) const {
+    for (size_t i = skip; i < lists.size(); ++i)
+        if (!std::binary_search(lists[i]->begin(), lists[i]->end(), d)) return false;
+    return true;
+}
+
+std::string CatalogIndex::search(const Query& q, const std::string& token, size_t limit,
+                                 std::vector<const Item*>& out) const {
+    out.clear();
+    if (limit == 0) return token;
+
+    // posting lists of the query's words, shortest first (it drives the intersection)
+    std::vector<const std::vector<Doc>*> lists;
+    for (auto &w : words(q.text)) {
+        auto it = postings.find(w);
+        if (it == postings.end()) return "";
+        lists.push_back(&it->second);
+    }
+    std::sort(lists.begin(), lists.end(), [](auto *a, auto *b) {
+        return a->size() != b->size() ? a->size() < b->size() : a < b;
+    });
+    lists.erase(std::unique(lists.begin(), lists.end()), lists.end());
+
+    if (q.order == Order::CATALOG) {
+        // token: the last Doc returned
+        Doc from = 0;
+        if (!token.empty() && std::from_chars(token.data(), token.data() + token.size(), from).ec == std::errc())
+            ++from;
+        auto emit = [&](Doc d) {
+            out.push_back(items[d]);
+            return out.size() == limit;
+        };
+        if (lists.empty()) {
+            for (Doc d = from; d < items.size(); ++d)
+                if (matches(d, q) && emit(d)) return std::to_string(d);
+        } else {
+            const std::vector<Doc> &first = *lists[0];
+            for (auto it = std::lower_bound(first.begin(), first.end(), from); it != first.end(); ++it)
+                if (matches(*it, q) && inAll(*it, lists, 1) && emit(*it)) return std::to_string(*it);
+        }
+        return "";
+    }
+
+    // token: "<cents>:<doc>" of the last item returned
+    bool asc = q.order == Order::PRICE_ASC;
+    bool resume = false;
+    PriceKey after;
+    size_t colon = token.find(':');
+    if (colon != std::string::npos) {
+        resume = std::from_chars(token.data(), token.data() + colon, after.first).ec == std::errc() &&
+                 std::from_chars(token.data() + colon + 1, token.data() + token.size(), after.second).ec == std::errc();
+    }
+    auto keyToken = [](const PriceKey& k) { return std::to_string(k.first) + ":" + std::to_string(k.second); };
+
+    // Two plans. Walk the price order, testing each item against every list: about
+    // limit / (share of items matching all words, taking words as independent) steps.
+    // Or collect the shortest list's matches and sort them: one step per entry, testing
+    // the other lists. Walk when the words match a large share of the catalog.
+    size_t m = lists.empty() ? 0 : lists[0]->size();
+    double share = 1, probe = std::log2((double)m + 2);
+    for (auto *l : lists) share *= (double)l->size() / (double)std::max<size_t>(items.size(), 1);
+    double walkCost = (double)limit / std::max(share, 1e-12) * (1 + lists.size() * probe);
+    double collectCost = (double)m * (1 + (lists.size() - 1) * probe);
+    if (lists.empty() || walkCost < collectCost) {
+        auto walk = [&](auto it, auto end, auto inRange) -> std::string {
+            for (; it != end && inRange(it->first); ++it) {
+                Doc d = it->second;
+                if (stock[d].get() < q.minStock || !inAll(d, lists, 0)) continue;
+                out.push_back(items[d]);
+                if (out.size() == limit) return keyToken(*it);
+            }
+            return "";
+        };
+        if (asc) {
+            PriceKey low{q.minPrice.cents, 0};
+            auto it = resume && !(after < low) ? byPrice.upper_bound(after) : byPrice.lower_bound(low);
+            return walk(it, byPrice.end(), [&](int64_t c) { return c <= q.maxPrice.cents; });
+        }
+        PriceKey high{q.maxPrice.cents, std::numeric_limits<Doc>::max()};
+        auto it = resume && after < high ? byPrice.lower_bound(after) : byPrice.upper_bound(high);
+        return walk(std::make_reverse_iterator(it), byPrice.rend(), [&](int64_t c) { return c >= q.minPrice.cents; });
+    }
+
+    std::vector<PriceKey> hits;
+    for (Doc d : *lists[0]) {
+        if (!matches(d, q) || !inAll(d, lists, 1)) continue;
+        PriceKey k{cents[d], d};
+        if (resume && !(asc ? after < k : k < after)) continue;
+        hits.push_back(k);
+    }
+    size_t n = std::min(limit, hits.size());
+    if (asc) std::partial_sort(hits.begin(), hits.begin() + n, hits.end());
+    else std::partial_sort(hits.begin(), hits.begin() + n, hits.end(), std::greater<PriceKey>());
+    for (size_t i = 0; i < n; ++i) out.push_back(items[hits[i].second]);
+    return hits.size() > limit ? keyToken(hits[n - 1]) : "";
+}
@@ -0,0 +1,72 @@
+#ifndef CATALOG_INDEX_H
+#define CATALOG_INDEX_H
+
+#include "money.h"
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class Item;
+
+// Search over the item catalog without scanning it: words of Item::name -> items
+// (inverted index), items ordered by price, and each item's price and stock mirrored
+// here so queries never read the Items themselves. Handles are the Items (Store never
+// erases one outside the loaders). Items are numbered in the order they are added
+// ("catalog order"); posting lists are kept in that order.
+// Synchronization is the caller's, except that the stock mirror is atomic: setStock may
+// run alongside searches, setPrice and other setStock calls, just not alongside add or clear.
+class CatalogIndex {
+public:
+    enum class Order { PRICE_ASC, PRICE_DESC, CATALOG };
+    struct Query {
+        std::string text;     // every word must occur in the name ("" matches all)
+        Money minPrice;       // inclusive range
+        Money maxPrice{std::numeric_limits<int64_t>::max()};
+        int minStock = 0;     // 1: in stock only
+        Order order = Order::PRICE_ASC;
+    };
+
+    void add(const Item* item); // a new item, with its current name, price and stock
+    void setPrice(const Item* item, Money price);
+    void setStock(const Item* item, int stock);
+    void clear();
+    size_t size() const { return items.size(); }
+
+    // Up to `limit` matches in query order, resuming after `token` ("" = from the start).
+    // Returns the token to continue from: "" once no match is left (a full page always
+    // gets one, so the last page may come back empty). Tokens hold positions, not items:
+    // they stay valid across updates but not across clear().
+    std::string search(const Query& q, const std::string& token, size_t limit,
+                       std::vector<const Item*>& out) const;
+
+    // lower-cased runs of letters and digits (bytes >= 0x80 count as letters, so UTF-8 words stay whole)
+    static std::vector<std::string> words(std::string_view text);
+
+private:
+    using Doc = uint32_t;
+    using PriceKey = std::pair<int64_t, Doc>; // cents, then catalog order
+    struct Stock { // copyable so the vector can grow, which only add does
+        std::atomic<int> n;
+        Stock(int n) : n(n) {}
+        Stock(const Stock& o) : n(o.n.load(std::memory_order_relaxed)) {}
+        int get() const { return n.load(std::memory_order_relaxed); }
+    };
+
+    bool matches(Doc d, const Query& q) const;
+    bool inAll(Doc d, const std::vector<const std::vector<Doc>*>& lists, size_t skip) const;
+
+    std::vector<const Item*> items; // by Doc
+    std::vector<int64_t> cents;
+    std::vector<Stock> stock;
+    std::unordered_map<const Item*, Doc> docOf;
+    std::unordered_map<std::string, std::vector<Doc>> postings; // ascending Docs
+    std::set<PriceKey> byPrice;
+};
+
+#endif // CATALOG_INDEX_H
@@ -1,27 +1,177 @@
 #include "data_manager.h"
+#include "metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <sstream>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 // Simple text-based dump. You can extend to robust CSV/JSON if needed.
 
+namespace {
+
+// Splits line at sep into at most n fields; the last field keeps the rest of the line.
+size_t splitFields(std::string_view line, char sep, std::string_view* out, size_t n) {
+    size_t count = 0;
+    while (count + 1 < n) {
+        size_t cut = line.find(sep);
+        if (cut == std::string_view::npos) break;
+        out[count++] = line.substr(0, cut);
+        line.remove_prefix(cut + 1);
+    }
+    out[count++] = line;
+    return count;
+}
+
+template <class T> T toNum(std::string_view s) {
+    T v{};
+    std::from_chars(s.data(), s.data() + s.size(), v);
+    return v;
+}
+
+Money toMoney(std::string_view s) {
+    Money m;
+    Money::tryParse(s.data(), s.size(), m);
+    return m;
+}
+
+// accounts/buyers/sellers.txt mix header lines "id|..." with history or link lines "id,...".
+// The separator right after the ID tells them apart; later fields (owner names, bank
+// notes) may contain either character.
+bool isHeaderLine(std::string_view line) {
+    size_t sep = line.find_first_of("|,");
+    return sep != std::string_view::npos && line[sep] == '|';
+}
+
+// accounts.txt header: accountID|ownerName|balance[|txCount]
+bool parseAccountHeader(std::string_view line, BankAccount& acc) {
+    std::string_view f[4];
+    size_t n = splitFields(line, '|', f, 4);
+    if (n < 3) return false;
+    acc = BankAccount(std::string(f[0]), std::string(f[1]), toMoney(f[2]));
+    if (n == 4) acc.txs.reserve(toNum<size_t>(f[3]));
+    return true;
+}
+
+// accounts.txt history: accountID,date,amount,note
+bool parseBankTx(std::string_view line, std::string_view& id, BankTx& tx) {
+    std::string_view f[4];
+    if (splitFields(line, ',', f, 4) != 4) return false;
+    if (!Date::tryParse(f[1].data(), f[1].size(), tx.date)) return false;
+    id = f[0];
+    tx.amount = toMoney(f[2]);
+    tx.note = Sym(f[3]);
+    return true;
+}
+
+// items.txt: itemID|name|price|stock|sold
+bool parseItem(std::string_view line, Item& it) {
+    std::string_view f[5];
+    if (splitFields(line, '|', f, 5) != 5) return false;
+    it = Item(std::string(f[0]), std::string(f[1]), toMoney(f[2]), toNum<int>(f[3]));
+    it.soldCount = toNum<int>(f[4]);
+    return true;
+}
+
+// buyers.txt / sellers.txt: userID|username|password, or userID,linkedID
+bool parseUserHeader(std::string_view line, std::string_view* f) {
+    std::string_view raw[3];
+    if (splitFields(line, '|', raw, 3) != 3) return false;
+    f[0] = raw[0];
+    f[1] = raw[1];
+    f[2] = raw[2].substr(0, raw[2].find('|'));
+    return true;
+}
+
+bool parseLink(std::string_view line, std::string_view& id, std::string_view& part) {
+    std::string_view f[2];
+    if (splitFields(line, ',', f, 2) != 2) return false;
+    id = f[0];
+    part = f[1].substr(0, f[1].find(','));
+    return true;
+}
+
+// transactions.txt: txID|date|buyer|seller|itemID|itemName|qty|price|status
+bool parseTransaction(std::string_view line, Transaction& t) {
+    std::string_view f[9];
+    if (splitFields(line, '|', f, 9) != 9) return false;
+    t = Transaction(Sym(f[0]), Date::parse(std::string(f[1])), Sym(f[2]), Sym(f[3]),
+                    Sym(f[4]), Sym(f[5]), toNum<int>(f[6]), toMoney(f[7]),
+                    (TransactionStatus)toNum<int>(f[8]));
+    return true;
+}
+
+// Read-only mapping of a whole file; an empty file maps to an empty view.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0) {
+            opened = true;
+            size = (size_t)st.st_size;
+            if (size > 0) {
+                void* m = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (m == MAP_FAILED) opened = false;
+                else {
+                    data = static_cast<const char*>(m);
+                    madvise(m, size, MADV_SEQUENTIAL);
+                }
+            }
+        }
+        ::close(fd);
+    }
+    ~MappedFile() { if (data) munmap(const_cast<char*>(data), size); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool ok() const { return opened; }
+    std::string_view view() const { return std::string_view(data ? data : "", data ? size : 0); }
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+    bool opened = false;
+};
+
+} // namespace
+
+
 bool DataManager::saveStore(const Store& store, const std::string& folder) {
+    OpTimer timer(Op::SAVE_STORE);
     // save accounts
     {
         std::ofstream f(folder + "/accounts.txt");
-        if (!f) return false;
+        if (!f) return timer.fail("io_error");
         for (auto &p : store.bank->accounts) {
             const auto &acc = p.second;
-            f << acc.accountID << "|" << acc.ownerName << "|" << acc.balance << "\n";
+            // trailing tx count lets the loader reserve history capacity up front
+            f << acc.accountID << "|" << acc.ownerName << "|" << acc.balance << "|" << acc.txs.size() << "\n";
             for (auto &tx : acc.txs) {
-                f << acc.accountID << "," << tx.date << "," << tx.amount << "," << tx.note << "\n";
+                f << acc.accountID << "," << tx.date.str() << "," << tx.amount << "," << tx.note << "\n";
             }
         }
     }
     // save items
     {
         std::ofstream f(folder + "/items.txt");
-        if (!f) return false;
+        if (!f) return timer.fail("io_error");
         for (auto &p : store.items) {
             const auto &it = p.second;
             f << it.itemID << "|" << it.name << "|" << it.price << "|" << it.stock << "|" << it.soldCount << "\n";
@@ -30,7 +180,7 @@ bool DataManager::saveStore(const Store& store, const std::string& folder) {
     // save users (buyers)
     {
         std::ofstream f(folder + "/buyers.txt");
-        if (!f) return false;
+        if (!f) return timer.fail("io_error");
         for (auto &p : store.buyers) {
             const auto &b = p.second;
             f << b.userID << "|" << b.username << "|" << b.password << "\n";
@@ -40,7 +190,7 @@ bool DataManager::saveStore(const Store& store, const std::string& folder) {
     // save users (sellers)
     {
         std::ofstream f(folder + "/sellers.txt");
-        if (!f) return false;
+        if (!f) return timer.fail("io_error");
         for (auto &p : store.sellers) {
             const auto &s = p.second;
             f << s.userID << "|" << s.username << "|" << s.password << "\n";
@@ -51,10 +201,10 @@ bool DataManager::saveStore(const Store& store, const std::string& folder) {
     // save transactions
     {
         std::ofstream f(folder + "/transactions.txt");
-        if (!f) return false;
+        if (!f) return timer.fail("io_error");
         for (auto &p : store.transactions) {
             const auto &t = p.second;
-            f << t.transactionID << "|" << t.date << "|" << t.buyerID << "|" << t.sellerID << "|" << t.itemID
+            f << t.transactionID << "|" << t.date.str() << "|" << t.buyerID << "|" << t.sellerID << "|" << t.itemID
               << "|" << t.itemName << "|" << t.quantity << "|" << t.totalPrice << "|" << (int)t.status << "\n";
         }
     }
@@ -63,6 +213,7 @@ bool DataManager::saveStore(const Store& store, const std::string& folder) {
 
 bool DataManager::loadStore(Store& store, const std::string& folder) {
     // NOTE: This basic loader assumes files exist and are consistent. Add checks when needed.
+    OpTimer timer(Op::LOAD_STORE);
 
     store.items.clear();
     store.buyers.clear();
@@ -70,29 +221,31 @@ bool DataManager::loadStore(Store& store, const std::string& folder) {
     store.transactions.clear();
     if (!store.bank) store.bank = new Bank();
 
-    // load accounts
+    // load accounts: one streaming pass. Lines are either
+    //   accountID|ownerName|balance[|txCount]   or   accountID,date,amount,note
+    // (see isHeaderLine) and history lines follow their account's header line.
+    store.bank->accounts.clear();
     {
         std::ifstream f(folder + "/accounts.txt");
-        if (!f) return false;
+        if (!f) return timer.fail("io_error");
         std::string line;
-        // First read basic accounts
-        std::vector<std::string> lines;
+        BankAccount* cur = nullptr;
         while (std::getline(f, line)) {
             if (line.empty()) continue;
-            lines.push_back(line);
-        }
-        // parse account lines and tx lines from those lines:
-        for (auto &ln : lines) {
-            // accounts lines were in form accountID|ownerName|balance OR accountID,date,amount,note
-            if (ln.find('|') != std::string::npos) {
-                std::istringstream ss(ln);
-                std::string id, owner; double bal;
-                std::getline(ss, id, '|');
-                std::getline(ss, owner, '|');
-                ss >> bal;
-                store.bank->createAccount(id, owner, bal);
+            if (isHeaderLine(line)) {
+                BankAccount acc;
+                if (!parseAccountHeader(line, acc)) continue;
+                std::string id = acc.accountID;
+                cur = &store.bank->accounts.insert_or_assign(id, std::move(acc)).first->second;
             } else {
-                // ignore other forms here
+                std::string_view id;
+                BankTx tx;
+                if (!parseBankTx(line, id, tx)) continue;
+                if (!cur || cur->accountID != id) {
+                    cur = store.bank->getAccount(std::string(id));
+                    if (!cur) continue;
+                }
+                cur->txs.push_back(std::move(tx));
             }
         }
     }
@@ -100,21 +253,11 @@ bool DataManager::loadStore(Store& store, const std::string& folder) {
     // items
     {
         std::ifstream f(folder + "/items.txt");
-        if (!f) /*ignore*/;
         std::string line;
         while (std::getline(f, line)) {
             if (line.empty()) continue;
-            std::istringstream ss(line);
-            std::string id, name;
-            double price; int stock, sold;
-            std::getline(ss, id, '|');
-            std::getline(ss, name, '|');
-            ss >> price; ss.ignore(1,'|');
-            ss >> stock; ss.ignore(1,'|');
-            ss >> sold;
-            Item it(id, name, price, stock);
-            it.soldCount = sold;
-            store.items[id] = it;
+            Item it;
+            if (parseItem(line, it)) store.items[it.itemID] = it;
         }
     }
 
@@ -125,22 +268,17 @@ bool DataManager::loadStore(Store& store, const std::string& folder) {
             std::string line;
             while (std::getline(f, line)) {
                 if (line.empty()) continue;
-                if (line.find('|') != std::string::npos) {
-                    std::istringstream ss(line);
-                    std::string id, uname, pass;
-                    std::getline(ss, id, '|');
-                    std::getline(ss, uname, '|');
-                    std::getline(ss, pass, '|');
-                    store.buyers[id] = Buyer(id, uname, pass);
+                std::string_view u[3], id, oid;
+                if (isHeaderLine(line)) {
+                    if (!parseUserHeader(line, u)) continue;
+                    std::string bid(u[0]), uname(u[1]);
+                    store.buyers[bid] = Buyer(bid, uname, std::string(u[2]));
                     // ensure bank account exists
-                    if (store.bank->getAccount(id) == nullptr) store.bank->createAccount(id, uname, 0.0);
-                } else if (line.find(',') != std::string::npos) {
+                    if (store.bank->getAccount(bid) == nullptr) store.bank->createAccount(bid, uname);
+                } else if (parseLink(line, id, oid)) {
                     // order mapping
-                    std::istringstream ss(line);
-                    std::string id, oid;
-                    std::getline(ss, id, ',');
-                    std::getline(ss, oid, ',');
-                    if (store.buyers.find(id) != store.buyers.end()) store.buyers[id].orderIDs.push_back(oid);
+                    auto bit = store.buyers.find(std::string(id));
+                    if (bit != store.buyers.end()) bit->second.orderIDs.emplace_back(oid);
                 }
             }
         }
@@ -153,21 +291,20 @@ bool DataManager::loadStore(Store& store, const std::string& folder) {
             std::string line;
             while (std::getline(f, line)) {
                 if (line.empty()) continue;
-                if (line.find('|') != std::string::npos) {
-                    std::istringstream ss(line);
-                    std::string id, uname, pass;
-                    std::getline(ss, id, '|');
-                    std::getline(ss, uname, '|');
-                    std::getline(ss, pass, '|');
-                    store.sellers[id] = Seller(id, uname, pass);
-                    if (store.bank->getAccount(id) == nullptr) store.bank->createAccount(id, uname, 0.0);
-                } else if (line.find(',') != std::string::npos) {
-                    std::istringstream ss(line);
-                    std::string id, part;
-                    std::getline(ss, id, ',');
-                    std::getline(ss, part, ',');
-                    // Part could be itemID or txID. We'll push both into itemIDs and saleTxIDs; correctness depends on consistency.
-                    if (store.sellers.find(id) != store.sellers.end()) store.sellers[id].itemIDs.push_back(part);
+                std::string_view u[3], id, part;
+                if (isHeaderLine(line)) {
+                    if (!parseUserHeader(line, u)) continue;
+                    std::string sid(u[0]), uname(u[1]);
+                    store.sellers[sid] = Seller(sid, uname, std::string(u[2]));
+                    if (store.bank->getAccount(sid) == nullptr) store.bank->createAccount(sid, uname);
+                } else if (parseLink(line, id, part)) {
+                    // Part could be itemID or txID; items are already loaded, so anything else is a sale.
+                    auto sit = store.sellers.find(std::string(id));
+                    if (sit != store.sellers.end()) {
+                        std::string p(part);
+                        if (store.items.find(p) != store.items.end()) sit->second.itemIDs.push_back(p);
+                        else sit->second.saleTxIDs.push_back(p);
+                    }
                 }
             }
         }
@@ -180,23 +317,504 @@ bool DataManager::loadStore(Store& store, const std::string& folder) {
             std::string line;
             while (std::getline(f, line)) {
                 if (line.empty()) continue;
-                std::istringstream ss(line);
-                std::string txid, date, buyer, seller, itemid, itemname;
-                int qty; double price; int statusi;
-                std::getline(ss, txid, '|');
-                std::getline(ss, date, '|');
-                std::getline(ss, buyer, '|');
-                std::getline(ss, seller, '|');
-                std::getline(ss, itemid, '|');
-                std::getline(ss, itemname, '|');
-                ss >> qty; ss.ignore(1,'|');
-                ss >> price; ss.ignore(1,'|');
-                ss >> statusi;
-                Transaction t(txid, date, buyer, seller, itemid, itemname, qty, price, (TransactionStatus)statusi);
-                store.transactions[txid] = t;
+                Transaction t;
+                if (parseTransaction(line, t)) store.transactions[t.transactionID] = t;
+            }
+        }
+    }
+
+    store.rebuildIndexes();
+    return true;
+}
+
+// ------------------------------
+// Parallel text load
+// ------------------------------
+// Every file is mapped and cut into newline-aligned chunks. Chunks are parsed on a
+// pool of threads into private buffers, then merged into Store/Bank in file order
+// (independent maps concurrently) and cross-linked.
+
+namespace {
+
+enum LoadFile { F_ACCOUNTS, F_ITEMS, F_BUYERS, F_SELLERS, F_TXS, F_NUM };
+
+struct ParsedChunk {
+    LoadFile file;
+    std::string_view text;
+    std::vector<BankAccount> accounts;
+    std::vector<Item> items;
+    std::vector<Buyer> buyers;
+    std::vector<Seller> sellers; // itemIDs holds every linked ID until items are known
+    std::vector<Transaction> txs;
+    // lines that don't follow their own header in this chunk (header is in an earlier one)
+    std::vector<std::pair<std::string, BankTx>> strayTxs;
+    std::vector<std::pair<std::string, std::string>> strayLinks;
+};
+
+template <class F> void runParallel(size_t tasks, unsigned threads, F fn) {
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i; (i = next.fetch_add(1)) < tasks;) fn(i);
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads && t < tasks; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto &th : pool) th.join();
+}
+
+void splitChunks(LoadFile file, std::string_view text, size_t target, std::vector<ParsedChunk>& out) {
+    while (!text.empty()) {
+        size_t cut = text.size();
+        if (target < text.size()) {
+            size_t nl = text.find('\n', target);
+            if (nl != std::string_view::npos) cut = nl + 1;
+        }
+        ParsedChunk c;
+        c.file = file;
+        c.text = text.substr(0, cut);
+        out.push_back(std::move(c));
+        text.remove_prefix(cut);
+    }
+}
+
+template <class U> void parseUsers(ParsedChunk& c, std::string_view line, std::vector<U>& users) {
+    std::string_view u[3], id, part;
+    if (isHeaderLine(line)) {
+        if (parseUserHeader(line, u)) users.emplace_back(std::string(u[0]), std::string(u[1]), std::string(u[2]));
+    } else if (parseLink(line, id, part)) {
+        std::vector<Sym>* links = nullptr;
+        if (!users.empty() && users.back().userID == id) {
+            if constexpr (std::is_same_v<U, Buyer>) links = &users.back().orderIDs;
+            else links = &users.back().itemIDs;
+        }
+        if (links) links->emplace_back(Sym(part));
+        else c.strayLinks.emplace_back(std::string(id), std::string(part));
+    }
+}
+
+void parseChunk(ParsedChunk& c) {
+    std::string_view text = c.text;
+    while (!text.empty()) {
+        size_t nl = text.find('\n');
+        std::string_view line = text.substr(0, nl);
+        text.remove_prefix(nl == std::string_view::npos ? text.size() : nl + 1);
+        if (line.empty()) continue;
+
+        switch (c.file) {
+        case F_ACCOUNTS:
+            if (isHeaderLine(line)) {
+                BankAccount acc;
+                if (parseAccountHeader(line, acc)) c.accounts.push_back(std::move(acc));
+            } else {
+                std::string_view id;
+                BankTx tx;
+                if (!parseBankTx(line, id, tx)) break;
+                if (!c.accounts.empty() && c.accounts.back().accountID == id) c.accounts.back().txs.push_back(std::move(tx));
+                else c.strayTxs.emplace_back(std::string(id), std::move(tx));
+            }
+            break;
+        case F_ITEMS: {
+            Item it;
+            if (parseItem(line, it)) c.items.push_back(std::move(it));
+            break;
+        }
+        case F_BUYERS:
+            parseUsers(c, line, c.buyers);
+            break;
+        case F_SELLERS:
+            parseUsers(c, line, c.sellers);
+            break;
+        case F_TXS: {
+            Transaction t;
+            if (parseTransaction(line, t)) c.txs.push_back(std::move(t));
+            break;
+        }
+        default:
+            break;
+        }
+    }
+}
+
+} // namespace
+
+bool DataManager::loadStoreParallel(Store& store, const std::string& folder, unsigned threads) {
+    OpTimer timer(Op::LOAD_STORE);
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    static const char* names[F_NUM] = {"accounts.txt", "items.txt", "buyers.txt", "sellers.txt", "transactions.txt"};
+    std::vector<std::unique_ptr<MappedFile>> files;
+    size_t total = 0;
+    for (int f = 0; f < F_NUM; ++f) {
+        files.push_back(std::make_unique<MappedFile>(folder + "/" + names[f]));
+        total += files.back()->view().size();
+    }
+    if (!files[F_ACCOUNTS]->ok()) return timer.fail("io_error");
+
+    // a few chunks per thread keeps the pool busy when files differ a lot in size
+    size_t target = std::max<size_t>(1 << 20, total / (threads * 4) + 1);
+    std::vector<ParsedChunk> chunks;
+    for (int f = 0; f < F_NUM; ++f) splitChunks((LoadFile)f, files[f]->view(), target, chunks);
+    runParallel(chunks.size(), threads, [&chunks](size_t i) { parseChunk(chunks[i]); });
+
+    store.items.clear();
+    store.buyers.clear();
+    store.sellers.clear();
+    store.transactions.clear();
+    if (!store.bank) store.bank = new Bank();
+    Bank& bank = *store.bank;
+    bank.accounts.clear();
+
+    // accounts, items and transactions land in separate maps: merge them side by side
+    auto mergeAccounts = [&]() {
+        for (auto &c : chunks) {
+            if (c.file != F_ACCOUNTS) continue;
+            for (auto &acc : c.accounts) {
+                std::string id = acc.accountID;
+                bank.accounts.insert_or_assign(bank.accounts.end(), id, std::move(acc));
+            }
+            for (auto &st : c.strayTxs) {
+                auto it = findByText(bank.accounts, st.first);
+                if (it != bank.accounts.end()) it->second.txs.push_back(std::move(st.second));
+            }
+        }
+    };
+    auto mergeItems = [&]() {
+        for (auto &c : chunks) {
+            if (c.file != F_ITEMS) continue;
+            for (auto &it : c.items) {
+                std::string id = it.itemID;
+                store.items.insert_or_assign(store.items.end(), id, std::move(it));
+            }
+        }
+    };
+    auto mergeTxs = [&]() {
+        for (auto &c : chunks) {
+            if (c.file != F_TXS) continue;
+            for (auto &t : c.txs) {
+                Sym id = t.transactionID;
+                store.transactions.insert_or_assign(store.transactions.end(), id, std::move(t));
+            }
+        }
+    };
+    std::function<void()> merges[] = {mergeAccounts, mergeItems, mergeTxs};
+    runParallel(3, threads, [&merges](size_t i) { merges[i](); });
+
+    // users need the merged accounts (to fill gaps) and items (to tell item links from sales)
+    for (auto &c : chunks) {
+        if (c.file == F_BUYERS) {
+            for (auto &b : c.buyers) {
+                std::string id = b.userID;
+                if (!bank.getAccount(id)) bank.createAccount(id, b.username);
+                store.buyers.insert_or_assign(store.buyers.end(), id, std::move(b));
+            }
+            for (auto &sl : c.strayLinks) {
+                auto bit = store.buyers.find(sl.first);
+                if (bit != store.buyers.end()) bit->second.orderIDs.push_back(std::move(sl.second));
+            }
+        } else if (c.file == F_SELLERS) {
+            auto link = [&store](Seller& s, Sym part) {
+                if (store.items.find(part) != store.items.end()) s.itemIDs.push_back(part);
+                else s.saleTxIDs.push_back(part);
+            };
+            for (auto &s : c.sellers) {
+                std::string id = s.userID;
+                if (!bank.getAccount(id)) bank.createAccount(id, s.username);
+                std::vector<Sym> parts;
+                parts.swap(s.itemIDs);
+                for (Sym p : parts) link(s, p);
+                store.sellers.insert_or_assign(store.sellers.end(), id, std::move(s));
+            }
+            for (auto &sl : c.strayLinks) {
+                auto sit = store.sellers.find(sl.first);
+                if (sit != store.sellers.end()) link(sit->second, std::move(sl.second));
             }
         }
     }
 
+    store.rebuildIndexes();
     return true;
 }
+
+// ------------------------------
+// Binary snapshot
+// ------------------------------
+// Layout (native little-endian); money is i64 cents (v3+, f64 units before):
+//   header   "OSSNAP\0\0", u32 version, u32 string count, u64 WAL seq (v2+), then u64 record counts
+//   strings  u32 length + bytes, referenced everywhere below by u32 index
+//   accounts {u32 id, u32 owner, i64 balance, u64 txCount} each followed by
+//            txCount bank txs {i32 day, u32 note, i64 amount}
+//   items    {u32 id, u32 name, i64 price, i32 stock, i32 sold}
+//   buyers   {u32 id, u32 username, u32 password, u32 orders} + orders x u32 txID
+//   sellers  {u32 id, u32 username, u32 password, u32 items, u32 sales} + item/tx IDs
+//   txs      {u32 id, i32 day, u32 buyer, u32 seller, u32 item, u32 name, i32 qty, i64 price, u8 status}
+
+namespace {
+
+const char kSnapMagic[8] = {'O', 'S', 'S', 'N', 'A', 'P', 0, 0};
+const uint32_t kSnapVersion = 3;
+
+class SnapWriter {
+public:
+    void reserve(size_t nstrings) {
+        strings.reserve(nstrings);
+        index.reserve(nstrings);
+    }
+    uint32_t str(const std::string& s) {
+        // keys view the store's own strings, which outlive the writer
+        auto it = index.find(s);
+        if (it != index.end()) return it->second;
+        uint32_t id = (uint32_t)strings.size();
+        strings.push_back(&s);
+        index.emplace(std::string_view(s), id);
+        return id;
+    }
+    template <class T> void put(T v) { body.append(reinterpret_cast<const char*>(&v), sizeof(T)); }
+    void putStr(const std::string& s) { put<uint32_t>(str(s)); }
+
+    bool writeTo(const std::string& path, uint64_t walSeq, const uint64_t* counts, int n) {
+        std::string head(kSnapMagic, sizeof(kSnapMagic));
+        auto add = [&head](const void* p, size_t len) { head.append(static_cast<const char*>(p), len); };
+        uint32_t nstr = (uint32_t)strings.size();
+        add(&kSnapVersion, 4);
+        add(&nstr, 4);
+        add(&walSeq, 8);
+        add(counts, sizeof(uint64_t) * n);
+        for (auto *s : strings) {
+            uint32_t len = (uint32_t)s->size();
+            add(&len, 4);
+            head += *s;
+        }
+        std::string tmp = path + ".tmp";
+        std::FILE* f = std::fopen(tmp.c_str(), "wb");
+        if (!f) return false;
+        bool ok = std::fwrite(head.data(), 1, head.size(), f) == head.size()
+               && std::fwrite(body.data(), 1, body.size(), f) == body.size();
+        ok = std::fflush(f) == 0 && ok;
+        ok = fsync(fileno(f)) == 0 && ok;
+        std::fclose(f);
+        if (!ok) { std::remove(tmp.c_str()); return false; }
+        return std::rename(tmp.c_str(), path.c_str()) == 0;
+    }
+
+private:
+    std::vector<const std::string*> strings;
+    std::unordered_map<std::string_view, uint32_t> index;
+    std::string body;
+};
+
+class SnapReader {
+public:
+    SnapReader(const char* p, size_t n) : cur(p), end(p + n) {}
+    bool ok() const { return good; }
+    template <class T> T get() {
+        T v{};
+        if ((size_t)(end - cur) < sizeof(T)) { good = false; return v; }
+        std::memcpy(&v, cur, sizeof(T));
+        cur += sizeof(T);
+        return v;
+    }
+    std::string_view bytes(size_t n) {
+        if ((size_t)(end - cur) < n) { good = false; return {}; }
+        std::string_view v(cur, n);
+        cur += n;
+        return v;
+    }
+    // false (and the reader fails) when n records of at least size bytes each cannot fit
+    // in what is left: checked before reserving room for a count read from the file
+    bool fits(uint64_t n, size_t size) {
+        if (n > (uint64_t)(end - cur) / size) good = false;
+        return good;
+    }
+    std::string str() {
+        uint32_t i = get<uint32_t>();
+        if (i >= strings.size()) { good = false; return std::string(); }
+        return std::string(strings[i]);
+    }
+    Money money() { return version >= 3 ? Money(get<int64_t>()) : Money::fromDouble(get<double>()); }
+    Sym sym() { // interns each table entry once, however often it is referenced
+        uint32_t i = get<uint32_t>();
+        if (i >= strings.size()) { good = false; return Sym(); }
+        if (syms.empty()) syms.resize(strings.size());
+        if (syms[i].empty() && !strings[i].empty()) syms[i] = Sym(strings[i]);
+        return syms[i];
+    }
+    std::vector<std::string_view> strings; // views into the mapping
+    uint32_t version = kSnapVersion;
+
+private:
+    std::vector<Sym> syms;
+    const char* cur;
+    const char* end;
+    bool good = true;
+};
+
+enum SnapCount { C_ACCOUNTS, C_ITEMS, C_BUYERS, C_SELLERS, C_TXS, C_NUM };
+
+} // namespace
+
+bool DataManager::saveSnapshot(const Store& store, const std::string& path) {
+    OpTimer timer(Op::SAVE_SNAPSHOT);
+    SnapWriter w;
+    uint64_t counts[C_NUM] = {};
+    w.reserve((store.bank ? store.bank->accounts.size() : 0) + store.items.size() * 2
+              + store.buyers.size() * 2 + store.sellers.size() * 2 + store.transactions.size());
+    if (store.bank) {
+        counts[C_ACCOUNTS] = store.bank->accounts.size();
+        for (auto &p : store.bank->accounts) {
+            const auto &acc = p.second;
+            w.putStr(acc.accountID);
+            w.putStr(acc.ownerName);
+            w.put<int64_t>(acc.balance.cents);
+            w.put<uint64_t>(acc.txs.size());
+            for (auto &tx : acc.txs) {
+                w.put<int32_t>(tx.date.day);
+                w.putStr(tx.note);
+                w.put<int64_t>(tx.amount.cents);
+            }
+        }
+    }
+    counts[C_ITEMS] = store.items.size();
+    for (auto &p : store.items) {
+        const auto &it = p.second;
+        w.putStr(it.itemID);
+        w.putStr(it.name);
+        w.put<int64_t>(it.price.cents);
+        w.put<int32_t>(it.stock);
+        w.put<int32_t>(it.soldCount);
+    }
+    counts[C_BUYERS] = store.buyers.size();
+    for (auto &p : store.buyers) {
+        const auto &b = p.second;
+        w.putStr(b.userID);
+        w.putStr(b.username);
+        w.putStr(b.password);
+        w.put<uint32_t>((uint32_t)b.orderIDs.size());
+        for (auto &oid : b.orderIDs) w.putStr(oid);
+    }
+    counts[C_SELLERS] = store.sellers.size();
+    for (auto &p : store.sellers) {
+        const auto &s = p.second;
+        w.putStr(s.userID);
+        w.putStr(s.username);
+        w.putStr(s.password);
+        w.put<uint32_t>((uint32_t)s.itemIDs.size());
+        w.put<uint32_t>((uint32_t)s.saleTxIDs.size());
+        for (auto &iid : s.itemIDs) w.putStr(iid);
+        for (auto &txid : s.saleTxIDs) w.putStr(txid);
+    }
+    counts[C_TXS] = store.transactions.size();
+    for (auto &p : store.transactions) {
+        const auto &t = p.second;
+        w.putStr(t.transactionID);
+        w.put<int32_t>(t.date.day);
+        w.putStr(t.buyerID);
+        w.putStr(t.sellerID);
+        w.putStr(t.itemID);
+        w.putStr(t.itemName);
+        w.put<int32_t>(t.quantity);
+        w.put<int64_t>(t.totalPrice.cents);
+        w.put<uint8_t>((uint8_t)t.status);
+    }
+    return w.writeTo(path, store.walSeq, counts, C_NUM) || timer.fail("io_error");
+}
+
+bool DataManager::loadSnapshot(Store& store, const std::string& path) {
+    OpTimer timer(Op::LOAD_SNAPSHOT);
+    MappedFile file(path);
+    if (!file.ok() || file.view().empty()) return timer.fail("no_snapshot");
+
+    SnapReader r(file.view().data(), file.view().size());
+    bool ok = r.bytes(sizeof(kSnapMagic)) == std::string_view(kSnapMagic, sizeof(kSnapMagic));
+    uint32_t version = r.version = r.get<uint32_t>();
+    ok = ok && version >= 1 && version <= kSnapVersion;
+    uint32_t nstr = r.get<uint32_t>();
+    uint64_t walSeq = version >= 2 ? r.get<uint64_t>() : 0;
+    uint64_t counts[C_NUM];
+    for (auto &c : counts) c = r.get<uint64_t>();
+    ok = ok && r.ok();
+    if (ok && r.fits(nstr, 4)) {
+        r.strings.reserve(nstr);
+        for (uint32_t i = 0; i < nstr && r.ok(); ++i) r.strings.push_back(r.bytes(r.get<uint32_t>()));
+    }
+    ok = ok && r.ok();
+    if (!ok) return timer.fail("bad_header");
+
+    store.items.clear();
+    store.buyers.clear();
+    store.sellers.clear();
+    store.transactions.clear();
+    if (!store.bank) store.bank = new Bank();
+    store.bank->accounts.clear();
+
+    for (uint64_t i = 0; i < counts[C_ACCOUNTS] && r.ok(); ++i) {
+        std::string id = r.str();
+        std::string owner = r.str();
+        BankAccount acc(id, owner, r.money());
+        uint64_t ntx = r.get<uint64_t>();
+        if (!r.fits(ntx, 16)) break; // day, note, amount
+        acc.txs.reserve(ntx);
+        for (uint64_t k = 0; k < ntx && r.ok(); ++k) {
+            Date d(r.get<int32_t>());
+            Sym note = r.sym();
+            acc.txs.push_back({d, r.money(), note});
+        }
+        store.bank->accounts.emplace_hint(store.bank->accounts.end(), id, std::move(acc));
+    }
+    for (uint64_t i = 0; i < counts[C_ITEMS] && r.ok(); ++i) {
+        std::string id = r.str();
+        std::string name = r.str();
+        Money price = r.money();
+        Item it(id, name, price, r.get<int32_t>());
+        it.soldCount = r.get<int32_t>();
+        store.items.emplace_hint(store.items.end(), id, std::move(it));
+    }
+    for (uint64_t i = 0; i < counts[C_BUYERS] && r.ok(); ++i) {
+        std::string id = r.str();
+        std::string uname = r.str();
+        Buyer b(id, uname, r.str());
+        uint32_t n = r.get<uint32_t>();
+        if (!r.fits(n, 4)) break;
+        b.orderIDs.reserve(n);
+        for (uint32_t k = 0; k < n && r.ok(); ++k) b.orderIDs.push_back(r.sym());
+        store.buyers.emplace_hint(store.buyers.end(), id, std::move(b));
+    }
+    for (uint64_t i = 0; i < counts[C_SELLERS] && r.ok(); ++i) {
+        std::string id = r.str();
+        std::string uname = r.str();
+        Seller s(id, uname, r.str());
+        uint32_t ni = r.get<uint32_t>();
+        uint32_t ns = r.get<uint32_t>();
+        if (!r.fits((uint64_t)ni + ns, 4)) break;
+        s.itemIDs.reserve(ni);
+        s.saleTxIDs.reserve(ns);
+        for (uint32_t k = 0; k < ni && r.ok(); ++k) s.itemIDs.push_back(r.sym());
+        for (uint32_t k = 0; k < ns && r.ok(); ++k) s.saleTxIDs.push_back(r.sym());
+        store.sellers.emplace_hint(store.sellers.end(), id, std::move(s));
+    }
+    for (uint64_t i = 0; i < counts[C_TXS] && r.ok(); ++i) {
+        Sym txid = r.sym();
+        Date d(r.get<int32_t>());
+        Sym buyer = r.sym();
+        Sym seller = r.sym();
+        Sym itemid = r.sym();
+        Sym itemname = r.sym();
+        int qty = r.get<int32_t>();
+        Money price = r.money();
+        auto status = (TransactionStatus)r.get<uint8_t>();
+        store.transactions.emplace_hint(store.transactions.end(), txid,
+            Transaction(txid, d, buyer, seller, itemid, itemname, qty, price, status));
+    }
+    ok = r.ok();
+    store.walSeq = walSeq;
+
+    store.rebuildIndexes();
+    return ok || timer.fail("truncated");
+}
+
+bool DataManager::checkpoint(Store& store, WriteAheadLog& wal, const std::string& snapshotPath) {
+    OpTimer timer(Op::CHECKPOINT);
+    if (!wal.flush()) return timer.fail("wal_flush");
+    store.walSeq = wal.lastSeq();
+    if (!saveSnapshot(store, snapshotPath)) return timer.fail("snapshot");
+    return wal.truncate() || timer.fail("wal_truncate");
+}
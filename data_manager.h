@@ -6,8 +6,21 @@
 
 class DataManager {
 public:
+    // text files (accounts/items/buyers/sellers/transactions .txt): import/export format
     static bool saveStore(const Store& store, const std::string& folder);
     static bool loadStore(Store& store, const std::string& folder);
+    // same files, parsed in newline-aligned chunks on `threads` threads (0 = hardware concurrency)
+    static bool loadStoreParallel(Store& store, const std::string& folder, unsigned threads = 0);
+
+    // versioned binary snapshot in a single file, loaded through mmap
+    static bool saveSnapshot(const Store& store, const std::string& path);
+    static bool loadSnapshot(Store& store, const std::string& path);
+
+    // snapshot + WAL truncate; the snapshot records wal.lastSeq() so replay skips what it already holds
+    static bool checkpoint(Store& store, WriteAheadLog& wal, const std::string& snapshotPath);
+
+    static const char* snapshotFile() { return "store.snap"; }
+    static const char* walFile() { return "store.wal"; }
 };
 
 #endif // DATA_MANAGER_H
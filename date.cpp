@@ -0,0 +1,84 @@
+#include "date.h"
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+
+// civil <-> day-number conversion (proleptic Gregorian), after H. Hinnant's days_from_civil
+Date Date::fromYMD(int y, int m, int d) {
+    y -= m <= 2;
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const int yoe = y - era * 400;
+    const int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return Date(era * 146097 + doe - 719468);
+}
+
+void Date::toYMD(int& y, int& m, int& d) const {
+    const int z = day + 719468;
+    const int era = (z >= 0 ? z : z - 146096) / 146097;
+    const int doe = z - era * 146097;
+    const int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const int mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp + (mp < 10 ? 3 : -9);
+    y = yoe + era * 400 + (m <= 2);
+}
+
+bool Date::tryParse(const char* s, std::size_t len, Date& out) {
+    if (len != 10 || s[4] != '-' || s[7] != '-') return false;
+    int v[8];
+    static const int pos[8] = {0, 1, 2, 3, 5, 6, 8, 9};
+    for (int i = 0; i < 8; ++i) {
+        char c = s[pos[i]];
+        if (c < '0' || c > '9') return false;
+        v[i] = c - '0';
+    }
+    int y = v[0] * 1000 + v[1] * 100 + v[2] * 10 + v[3];
+    int m = v[4] * 10 + v[5];
+    int d = v[6] * 10 + v[7];
+    if (m < 1 || m > 12 || d < 1 || d > 31) return false;
+    out = fromYMD(y, m, d);
+    return true;
+}
+
+Date Date::parse(const std::string& s) {
+    Date d;
+    tryParse(s.data(), s.size(), d);
+    return d;
+}
+
+Date Date::today() {
+    // expiry (seconds, high 32 bits) and day (low 32 bits) in one word, so a thread never
+    // pairs one refresh's day with another's expiry
+    static std::atomic<uint64_t> cache{0};
+    std::time_t now = std::time(nullptr);
+    uint64_t c = cache.load(std::memory_order_relaxed);
+    if ((uint64_t)now < c >> 32) return Date((int32_t)(uint32_t)c);
+
+    std::tm tm = {};
+    localtime_r(&now, &tm);
+    Date d = fromYMD(tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday);
+    tm.tm_hour = tm.tm_min = tm.tm_sec = 0;
+    tm.tm_mday += 1;
+    tm.tm_isdst = -1;
+    cache.store((uint64_t)(uint32_t)std::mktime(&tm) << 32 | (uint32_t)d.day, std::memory_order_relaxed);
+    return d;
+}
+
+std::string Date::str() const {
+    int y, m, d;
+    toYMD(y, m, d);
+    char buf[11];
+    buf[0] = char('0' + y / 1000 % 10);
+    buf[1] = char('0' + y / 100 % 10);
+    buf[2] = char('0' + y / 10 % 10);
+    buf[3] = char('0' + y % 10);
+    buf[4] = '-';
+    buf[5] = char('0' + m / 10);
+    buf[6] = char('0' + m % 10);
+    buf[7] = '-';
+    buf[8] = char('0' + d / 10);
+    buf[9] = char('0' + d % 10);
+    return std::string(buf, 10);
+}
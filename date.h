@@ -0,0 +1,35 @@
+#ifndef DATE_H
+#define DATE_H
+
+#include <cstddef>
+#include <string>
+
+// Calendar day stored as days since 1970-01-01, so comparing and
+// subtracting dates is plain integer math. Text form is YYYY-MM-DD.
+struct Date {
+    int day = 0;
+
+    Date() = default;
+    explicit Date(int d) : day(d) {}
+
+    static Date fromYMD(int y, int m, int d);
+    static bool tryParse(const char* s, std::size_t len, Date& out); // strict YYYY-MM-DD
+    static Date parse(const std::string& s); // epoch on malformed input
+    static Date today(); // local date, recomputed only when the day rolls over
+
+    void toYMD(int& y, int& m, int& d) const;
+    std::string str() const;
+
+    Date operator+(int days) const { return Date(day + days); }
+    Date operator-(int days) const { return Date(day - days); }
+    int operator-(Date o) const { return day - o.day; }
+
+    bool operator==(Date o) const { return day == o.day; }
+    bool operator!=(Date o) const { return day != o.day; }
+    bool operator<(Date o) const { return day < o.day; }
+    bool operator<=(Date o) const { return day <= o.day; }
+    bool operator>(Date o) const { return day > o.day; }
+    bool operator>=(Date o) const { return day >= o.day; }
+};
+
+#endif // DATE_H
@@ -0,0 +1,28 @@
+#include "dormancy_index.h"
+#include <utility>
+
+void DormancyIndex::touch(const BankAccount* account, Date day) {
+    auto ins = dayOf.try_emplace(account, day);
+    if (ins.second) {
+        byDay.insert({day, account});
+        return;
+    }
+    Date &known = ins.first->second;
+    if (day <= known) return;
+    auto node = byDay.extract({known, account});
+    known = day;
+    node.value().lastDay = day;
+    byDay.insert(std::move(node));
+}
+
+void DormancyIndex::clear() {
+    byDay.clear();
+    dayOf.clear();
+}
+
+std::vector<DormancyIndex::Entry> DormancyIndex::page(Date cutoff, const Entry& after, size_t limit) const {
+    std::vector<Entry> out;
+    auto it = after.account ? byDay.upper_bound(after) : byDay.begin();
+    for (; it != byDay.end() && it->lastDay < cutoff && out.size() < limit; ++it) out.push_back(*it);
+    return out;
+}
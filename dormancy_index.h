@@ -0,0 +1,40 @@
+#ifndef DORMANCY_INDEX_H
+#define DORMANCY_INDEX_H
+
+#include "date.h"
+#include <cstddef>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+class BankAccount;
+
+// Accounts ordered by last-activity day, so "idle since before day X" is a range
+// read from the front. Handles are the accounts themselves (Bank never erases one
+// outside the loaders), so results carry no copies or formatted strings.
+class DormancyIndex {
+public:
+    struct Entry {
+        Date lastDay;                         // epoch: no activity ever
+        const BankAccount* account = nullptr; // nullptr in a cursor: start from the beginning
+    };
+
+    void touch(const BankAccount* account, Date day); // activity on day; an older day than the known one is ignored
+    void clear();
+    size_t size() const { return dayOf.size(); }
+
+    // Accounts whose last activity is before cutoff, oldest first, resuming after
+    // `after` (the last entry of the previous page); at most limit entries.
+    std::vector<Entry> page(Date cutoff, const Entry& after, size_t limit) const;
+
+private:
+    struct ByDay {
+        bool operator()(const Entry& a, const Entry& b) const {
+            return a.lastDay != b.lastDay ? a.lastDay < b.lastDay : a.account < b.account;
+        }
+    };
+    std::set<Entry, ByDay> byDay;
+    std::unordered_map<const BankAccount*, Date> dayOf;
+};
+
+#endif // DORMANCY_INDEX_H
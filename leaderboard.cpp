@@ -0,0 +1,56 @@
+#include "leaderboard.h"
+#include <algorithm>
+
+void Leaderboard::add(Sym key, int delta) {
+    // try_emplace and node re-keying keep a repeat key off the allocator
+    auto ins = counts.try_emplace(key, 0);
+    int &c = ins.first->second;
+    if (ins.second) {
+        c = delta;
+        ranked.emplace(c, key);
+        return;
+    }
+    if (delta == 0) return;
+    auto node = ranked.extract({c, key});
+    c += delta;
+    node.value().first = c;
+    ranked.insert(std::move(node));
+}
+
+int Leaderboard::count(Sym key) const {
+    auto it = counts.find(key);
+    return it == counts.end() ? 0 : it->second;
+}
+
+std::vector<std::pair<Sym, int>> Leaderboard::top(int n) const {
+    std::vector<std::pair<Sym, int>> out;
+    if (n <= 0) return out;
+    out.reserve(std::min<size_t>((size_t)n, ranked.size()));
+    for (auto it = ranked.begin(); it != ranked.end() && (int)out.size() < n; ++it)
+        out.emplace_back(it->second, it->first);
+    return out;
+}
+
+void Leaderboard::clear() {
+    counts.clear();
+    ranked.clear();
+}
+
+void DailyLeaderboard::add(Date d, Sym key, int delta) {
+    if (d < current) return;
+    if (d > current) {
+        board.clear();
+        current = d;
+    }
+    board.add(key, delta);
+}
+
+std::vector<std::pair<Sym, int>> DailyLeaderboard::top(Date d, int n) const {
+    if (d != current) return {};
+    return board.top(n);
+}
+
+void DailyLeaderboard::clear() {
+    current = Date();
+    board.clear();
+}
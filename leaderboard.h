@@ -0,0 +1,45 @@
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include "date.h"
+#include "symbol.h"
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Running count per key, with the keys also kept ordered by count so the top n
+// are read off the front instead of sorting every key. Ties go to the key interned first.
+class Leaderboard {
+public:
+    void add(Sym key, int delta = 1); // delta 0 just enters the key
+    int count(Sym key) const;         // 0 if never added
+    std::vector<std::pair<Sym, int>> top(int n) const;
+    size_t size() const { return counts.size(); }
+    void clear();
+
+private:
+    struct ByCount {
+        bool operator()(const std::pair<int, Sym>& a, const std::pair<int, Sym>& b) const {
+            return a.first != b.first ? a.first > b.first : a.second < b.second;
+        }
+    };
+    std::unordered_map<Sym, int> counts;
+    std::set<std::pair<int, Sym>, ByCount> ranked;
+};
+
+// Leaderboard for a single day. An event of a later day starts a fresh board
+// (the daily rollover); events of an earlier day no longer count and are dropped.
+class DailyLeaderboard {
+public:
+    void add(Date d, Sym key, int delta = 1);
+    std::vector<std::pair<Sym, int>> top(Date d, int n) const; // empty unless d is the board's day
+    Date day() const { return current; }
+    void clear();
+
+private:
+    Date current;
+    Leaderboard board;
+};
+
+#endif // LEADERBOARD_H
@@ -0,0 +1,45 @@
+#ifndef LOCK_STRIPES_H
+#define LOCK_STRIPES_H
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Fixed pool of mutexes; a key always maps to the same one. Records that share a
+// stripe serialize, everything else runs in parallel.
+class LockStripes {
+public:
+    explicit LockStripes(size_t n = 1024) : locks(n) {}
+    std::mutex& forKey(const std::string& key) {
+        return locks[std::hash<std::string>{}(key) % locks.size()];
+    }
+
+private:
+    std::vector<std::mutex> locks;
+};
+
+// Holds several stripe locks at once. They are taken in address order (duplicates
+// dropped), which is the single global order, so two MultiLocks can't deadlock.
+class MultiLock {
+public:
+    MultiLock(std::initializer_list<std::mutex*> ms) : held(ms) { lockAll(); }
+    explicit MultiLock(std::vector<std::mutex*> ms) : held(std::move(ms)) { lockAll(); }
+    ~MultiLock() {
+        for (auto it = held.rbegin(); it != held.rend(); ++it) (*it)->unlock();
+    }
+    MultiLock(const MultiLock&) = delete;
+    MultiLock& operator=(const MultiLock&) = delete;
+
+private:
+    void lockAll() {
+        std::sort(held.begin(), held.end());
+        held.erase(std::unique(held.begin(), held.end()), held.end());
+        for (auto *m : held) m->lock();
+    }
+
+    std::vector<std::mutex*> held;
+};
+
+#endif // LOCK_STRIPES_H
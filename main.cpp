@@ -1,15 +1,33 @@
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <map>
 #include <string>
+#include "batch.h"
 #include "models.h"
 #include "bank.h"
 #include "store.h"
 #include "data_manager.h"
+#include "metrics.h"
+#include "server.h"
+#include "wal.h"
 
 // ------------------------------
 // Forward declarations
 // ------------------------------
 void buyerMenu(Store& store, Buyer* buyer);
 void sellerMenu(Store& store, Seller* seller);
+void runBatch(Store& store, std::istream& in, WriteAheadLog& wal, const std::string& snapshot);
+
+const uint64_t kCompactEvery = 10000; // WAL records between automatic snapshots
+
+Server* serving = nullptr; // for the shutdown signal handler
+void stopServing(int) {
+    if (serving) serving->stop();
+}
 
 // ------------------------------
 // Demo data setup
@@ -17,33 +35,115 @@ void sellerMenu(Store& store, Seller* seller);
 void seedDemo(Store &store) {
     store.registerSeller("S1", "alice_seller", "123");
     store.registerBuyer("B1", "bob_buyer", "123");
-    store.addItem("S1", "I1", "Sword", 50.0, 10);
-    store.addItem("S1", "I2", "Shield", 30.0, 5);
+    store.addItem("S1", "I1", "Sword", Money::units(50), 10);
+    store.addItem("S1", "I2", "Shield", Money::units(30), 5);
+
+    Date t = Date::today();
+    store.bank->deposit("B1", Money::units(200), t, "topup demo");
+    store.bank->deposit("S1", Money(), t, "seller start");
+}
 
-    std::string t = Bank::todayDate();
-    store.bank->deposit("B1", 200.0, t, "topup demo");
-    store.bank->deposit("S1", 0.0, t, "seller start");
+// amounts are typed as units with up to two decimals, e.g. 12.5
+Money readMoney() {
+    std::string s;
+    std::cin >> s;
+    return Money::parse(s);
 }
 
 // ------------------------------
 // Main function
 // ------------------------------
-int main() {
+// Usage: main                          interactive menus
+//        main --batch FILE             run the commands in FILE (or "-" for stdin), see batch.h;
+//                                      responses go to stdout, a timing summary to stderr
+//        main --serve ADDR [WORKERS]   serve the same commands on ADDR ("PORT", "HOST:PORT" or
+//                                      "unix:PATH", see server.h) until SIGINT/SIGTERM
+// Operation metrics (metrics.h) are written to data_store/metrics.prom on exit, and about
+// once a second while serving; the "stats" command shows them too.
+int main(int argc, char** argv) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    std::string batchInput = argc == 3 && mode == "--batch" ? argv[2] : "";
+    std::string serveAddr = (argc == 3 || argc == 4) && mode == "--serve" ? argv[2] : "";
+    if (argc > 1 && batchInput.empty() && serveAddr.empty()) {
+        std::cerr << "usage: " << argv[0] << " [--batch FILE|- | --serve ADDR [WORKERS]]\n";
+        return 2;
+    }
+    bool interactive = argc == 1;
+    std::ostream& info = interactive ? std::cout : std::cerr; // keep batch stdout to responses
     Store store;
     Bank bank;
     store.setBank(&bank);
-    store.bank = &bank;
 
     std::string folder = "data_store";  // make sure this folder exists manually
 
-    std::cout << "=== Online Store Simulation ===\n";
-    std::cout << "Loading saved data (if any)...\n";
-    DataManager::loadStore(store, folder);
+    info << "=== Online Store Simulation ===\n";
+    info << "Loading saved data (if any)...\n";
+    // prefer the binary snapshot; the text files are the import/export format
+    std::string snapshot = folder + "/" + DataManager::snapshotFile();
+    if (!DataManager::loadSnapshot(store, snapshot))
+        DataManager::loadStore(store, folder);
     store.setBank(&bank);
-    store.bank = &bank;
+
+    // recover mutations made after the last snapshot, then keep logging
+    std::string walPath = folder + "/" + DataManager::walFile();
+    std::string metricsPath = folder + "/metrics.prom";
+    int64_t walBytes = -1;
+    long replayed = WriteAheadLog::replay(walPath, store, &walBytes);
+    if (replayed > 0) info << "Recovered " << replayed << " logged operations.\n";
+    WriteAheadLog wal;
+    if (wal.open(walPath, store.walSeq, walBytes)) { // drops a torn tail before appending
+        store.wal = &wal;
+        bank.wal = &wal;
+    }
+
+    if (!batchInput.empty()) {
+        std::ifstream file;
+        if (batchInput != "-") {
+            file.open(batchInput);
+            if (!file) {
+                std::cerr << "cannot open " << batchInput << "\n";
+                return 1;
+            }
+        }
+        std::ios::sync_with_stdio(false);
+        runBatch(store, batchInput == "-" ? std::cin : file, wal, snapshot);
+        if (wal.isOpen()) DataManager::checkpoint(store, wal, snapshot);
+        else DataManager::saveSnapshot(store, snapshot);
+        DataManager::saveStore(store, folder);
+        metrics().writePrometheusFile(metricsPath);
+        return 0;
+    }
+
+    if (!serveAddr.empty()) {
+        Server server(store, argc == 4 ? std::atoi(argv[3]) : 4);
+        if (!server.listen(serveAddr)) {
+            std::cerr << "cannot listen on " << serveAddr << "\n";
+            return 1;
+        }
+        serving = &server;
+        std::signal(SIGINT, stopServing);
+        std::signal(SIGTERM, stopServing);
+        std::signal(SIGPIPE, SIG_IGN);
+        info << "Serving on " << serveAddr << "\n";
+        server.run([&]() {
+            if (wal.isOpen() && wal.recordsSinceTruncate() >= kCompactEvery)
+                DataManager::checkpoint(store, wal, snapshot);
+            metrics().writePrometheusFile(metricsPath);
+        });
+        serving = nullptr;
+        if (wal.isOpen()) DataManager::checkpoint(store, wal, snapshot);
+        else DataManager::saveSnapshot(store, snapshot);
+        DataManager::saveStore(store, folder);
+        metrics().writePrometheusFile(metricsPath);
+        info << "Saved data and exit.\n";
+        return 0;
+    }
 
     bool running = true;
     while (running) {
+        if (wal.isOpen() && wal.recordsSinceTruncate() >= kCompactEvery)
+            DataManager::checkpoint(store, wal, snapshot);
+
         std::cout << "\n1) Register Buyer\n";
         std::cout << "2) Register Seller\n";
         std::cout << "3) Login\n";
@@ -90,7 +190,10 @@ int main() {
             std::cout << "Demo data created.\n";
         }
         else if (choice == 5) {
+            if (wal.isOpen()) DataManager::checkpoint(store, wal, snapshot);
+            else DataManager::saveSnapshot(store, snapshot);
             DataManager::saveStore(store, folder);
+            metrics().writePrometheusFile(metricsPath);
             std::cout << "Saved data and exit.\n";
             running = false;
         }
@@ -115,6 +218,8 @@ void buyerMenu(Store& store, Buyer* buyer) {
         std::cout << "4) View spending (last k days)\n";
         std::cout << "5) Top-up\n";
         std::cout << "6) Withdraw\n";
+        std::cout << "7) Cancel order\n";
+        std::cout << "8) Search items\n";
         std::cout << "0) Logout\n";
         std::cout << "Choice: ";
         int c; std::cin >> c;
@@ -130,10 +235,11 @@ void buyerMenu(Store& store, Buyer* buyer) {
             std::string iid; int qty;
             std::cout << "Item ID: "; std::cin >> iid;
             std::cout << "Quantity: "; std::cin >> qty;
-            std::string d = Bank::todayDate();
-            if (store.purchase(buyer->userID, iid, qty, d))
+            Date d = Date::today();
+            PurchaseStatus st = store.tryPurchaseWithID(store.genID("TX"), buyer->userID, iid, qty, d);
+            if (st == PurchaseStatus::OK)
                 std::cout << "Purchase successful.\n";
-            else std::cout << "Failed (balance/stock/id issue).\n";
+            else std::cout << "Failed (" << purchaseStatusName(st) << ").\n";
         }
         else if (c == 3) {
             for (auto& tid : buyer->orderIDs) {
@@ -149,29 +255,49 @@ void buyerMenu(Store& store, Buyer* buyer) {
         }
         else if (c == 4) {
             int k; std::cout << "Days: "; std::cin >> k;
-            double total = 0;
-            std::string today = Bank::todayDate();
-            for (auto& tid : buyer->orderIDs) {
-                auto it = store.transactions.find(tid);
-                if (it != store.transactions.end()) {
-                    const auto& t = it->second;
-                    if (Bank::daysBetween(today, t.date) <= k)
-                        total += t.totalPrice;
-                }
-            }
+            Money total = store.spendingLastKDays(buyer->userID, k);
             std::cout << "Total spending in last " << k << " days: " << total << "\n";
         }
         else if (c == 5) {
-            double amt; std::cout << "Top-up amount: "; std::cin >> amt;
-            store.bank->deposit(buyer->userID, amt, Bank::todayDate(), "topup");
+            std::cout << "Top-up amount: "; Money amt = readMoney();
+            store.bank->deposit(buyer->userID, amt, Date::today(), "topup");
             std::cout << "Balance: " << store.bank->getAccount(buyer->userID)->balance << "\n";
         }
         else if (c == 6) {
-            double amt; std::cout << "Withdraw amount: "; std::cin >> amt;
-            if (store.bank->withdraw(buyer->userID, amt, Bank::todayDate(), "withdraw"))
+            std::cout << "Withdraw amount: "; Money amt = readMoney();
+            if (store.bank->withdraw(buyer->userID, amt, Date::today(), "withdraw"))
                 std::cout << "Done. Balance: " << store.bank->getAccount(buyer->userID)->balance << "\n";
             else std::cout << "Not enough balance.\n";
         }
+        else if (c == 7) {
+            std::string tid; std::cout << "Transaction ID: "; std::cin >> tid;
+            if (store.cancelTransaction(buyer->userID, tid, Date::today()))
+                std::cout << "Canceled and refunded.\n";
+            else std::cout << "Failed (not yours, not PAID, or seller cannot refund).\n";
+        }
+        else if (c == 8) {
+            CatalogIndex::Query q;
+            std::string yn;
+            std::cin.ignore();
+            std::cout << "Words in name (empty = any): "; std::getline(std::cin, q.text);
+            std::cout << "Min price: "; q.minPrice = readMoney();
+            std::cout << "Max price (0 = no limit): "; Money max = readMoney();
+            if (max > Money()) q.maxPrice = max;
+            std::cout << "In stock only (y/n): "; std::cin >> yn;
+            q.minStock = yn == "y" ? 1 : 0;
+            std::string token;
+            do {
+                std::vector<Item> page;
+                token = store.searchItems(q, token, 20, page);
+                for (auto& item : page)
+                    std::cout << item.itemID << " | " << item.name
+                              << " | Price: " << item.price
+                              << " | Stock: " << item.stock << "\n";
+                if (page.empty()) std::cout << "No more items.\n";
+                if (token.empty()) break;
+                std::cout << "More (y/n)? "; std::cin >> yn;
+            } while (yn == "y");
+        }
     }
 }
 
@@ -187,17 +313,19 @@ void sellerMenu(Store& store, Seller* seller) {
         std::cout << "3) Discard item\n";
         std::cout << "4) Set price\n";
         std::cout << "5) View my items\n";
+        std::cout << "6) View pending orders\n";
+        std::cout << "7) Complete pending orders\n";
         std::cout << "0) Logout\n";
         std::cout << "Choice: ";
         int c; std::cin >> c;
 
         if (c == 0) break;
         else if (c == 1) {
-            std::string iid, name; double price; int stock;
+            std::string iid, name; Money price; int stock;
             std::cout << "Item ID: "; std::cin >> iid;
             std::cin.ignore();
             std::cout << "Item name: "; std::getline(std::cin, name);
-            std::cout << "Price: "; std::cin >> price;
+            std::cout << "Price: "; price = readMoney();
             std::cout << "Stock: "; std::cin >> stock;
             if (store.addItem(seller->userID, iid, name, price, stock))
                 std::cout << "Item added.\n";
@@ -220,9 +348,9 @@ void sellerMenu(Store& store, Seller* seller) {
             else std::cout << "Failed.\n";
         }
         else if (c == 4) {
-            std::string iid; double p;
+            std::string iid; Money p;
             std::cout << "Item ID: "; std::cin >> iid;
-            std::cout << "New price: "; std::cin >> p;
+            std::cout << "New price: "; p = readMoney();
             if (store.setItemPrice(seller->userID, iid, p))
                 std::cout << "Updated.\n";
             else std::cout << "Failed.\n";
@@ -238,5 +366,57 @@ void sellerMenu(Store& store, Seller* seller) {
                 }
             }
         }
+        else if (c == 6) {
+            std::cout << store.pendingCount(seller->userID) << " pending\n";
+            Transaction t;
+            if (store.nextPending(seller->userID, t))
+                std::cout << "Next: " << t.transactionID << " | " << t.itemName
+                          << " x" << t.quantity << " | " << t.totalPrice << "\n";
+        }
+        else if (c == 7) {
+            int n; std::cout << "How many (oldest first): "; std::cin >> n;
+            std::cout << store.completePending(seller->userID, n > 0 ? n : 0) << " completed.\n";
+        }
+    }
+}
+
+// ------------------------------
+// Batch mode
+// ------------------------------
+void runBatch(Store& store, std::istream& in, WriteAheadLog& wal, const std::string& snapshot) {
+    const size_t flushAt = 1 << 16;
+    struct Stat { long count = 0; double ns = 0; };
+    std::map<std::string, Stat, std::less<>> stats;
+    BatchExecutor exec(store);
+    BatchSession session;
+    std::string out, line;
+    long total = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (std::getline(in, line)) {
+        std::string_view verb = BatchExecutor::verb(line);
+        if (verb.empty()) continue;
+        auto t0 = std::chrono::steady_clock::now();
+        bool more = exec.execute(line, session, out);
+        auto t1 = std::chrono::steady_clock::now();
+        auto st = stats.find(verb);
+        if (st == stats.end()) st = stats.emplace(std::string(verb), Stat()).first;
+        ++st->second.count;
+        st->second.ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+        ++total;
+        if (out.size() >= flushAt) {
+            std::fwrite(out.data(), 1, out.size(), stdout);
+            out.clear();
+        }
+        if (wal.isOpen() && wal.recordsSinceTruncate() >= kCompactEvery)
+            DataManager::checkpoint(store, wal, snapshot);
+        if (!more) break;
     }
+    std::fwrite(out.data(), 1, out.size(), stdout);
+    std::fflush(stdout);
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::fprintf(stderr, "%ld commands in %.1f ms (%.0f/s)\n", total, ms, ms > 0 ? total / (ms / 1000) : 0.0);
+    for (auto &p : stats)
+        std::fprintf(stderr, "  %-18s %9ld  %10.1f ms  %8.2f us/cmd\n", p.first.c_str(), p.second.count,
+                     p.second.ns / 1e6, p.second.ns / 1e3 / p.second.count);
 }
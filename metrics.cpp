@@ -0,0 +1,171 @@
+#include "metrics.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+int Histogram::bucketOf(uint64_t ns) {
+    const uint64_t sub = 1u << kSubBits;
+    if (ns < sub) return (int)ns;
+    int e = 63 - __builtin_clzll(ns); // top bit, >= kSubBits
+    if (e > kMaxBits) return kBuckets - 1;
+    int shift = e - kSubBits;
+    return (int)(sub + (uint64_t)shift * sub + ((ns >> shift) & (sub - 1)));
+}
+
+uint64_t Histogram::bucketTop(int b) {
+    const uint64_t sub = 1u << kSubBits;
+    if ((uint64_t)b < sub) return (uint64_t)b;
+    int shift = (int)((b - sub) / sub);
+    uint64_t low = (sub + (b - sub) % sub) << shift;
+    return low + ((uint64_t)1 << shift) - 1;
+}
+
+void Histogram::record(uint64_t ns) {
+    buckets[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sumNs.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t m = maxNs.load(std::memory_order_relaxed);
+    while (ns > m && !maxNs.compare_exchange_weak(m, ns, std::memory_order_relaxed)) {}
+}
+
+uint64_t Histogram::percentile(double q) const {
+    uint64_t n = count();
+    if (n == 0) return 0;
+    uint64_t rank = (uint64_t)(q * n + 0.5);
+    if (rank < 1) rank = 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < kBuckets; ++b) {
+        seen += buckets[b].load(std::memory_order_relaxed);
+        if (seen >= rank) return std::min(bucketTop(b), max());
+    }
+    return max(); // buckets still catching up with a concurrent record()
+}
+
+void Histogram::reset() {
+    for (auto &b : buckets) b.store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    sumNs.store(0, std::memory_order_relaxed);
+    maxNs.store(0, std::memory_order_relaxed);
+}
+
+Metrics& metrics() {
+    static Metrics m;
+    return m;
+}
+
+const char* Metrics::name(Op op) {
+    static const char* names[] = {
+        "purchase", "purchase_batch", "login", "register", "add_item", "update_item",
+        "complete", "cancel", "complete_pending", "list_items", "search_items",
+        "report_transactions", "report_paid", "report_top_items", "report_spending", "report_active_users",
+        "deposit", "withdraw", "bank_report",
+        "load_store", "save_store", "load_snapshot", "save_snapshot", "checkpoint", "wal_replay", "wal_flush"};
+    static_assert(sizeof(names) / sizeof(names[0]) == (size_t)Op::COUNT, "one name per Op");
+    return names[(int)op];
+}
+
+void Metrics::addFailure(Op op, const char* reason) {
+    Reason* slots = ops[(int)op].reasons;
+    for (int i = 0; i < kMaxReasons; ++i) {
+        const char* have = slots[i].name.load(std::memory_order_acquire);
+        if (!have && slots[i].name.compare_exchange_strong(have, reason, std::memory_order_acq_rel)) have = reason;
+        if (have == reason || std::strcmp(have, reason) == 0 || i == kMaxReasons - 1) {
+            slots[i].n.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+}
+
+void Metrics::reset() {
+    for (auto &s : ops) {
+        s.ok.store(0, std::memory_order_relaxed);
+        for (auto &r : s.reasons) r.n.store(0, std::memory_order_relaxed);
+        s.latency.reset();
+    }
+}
+
+uint64_t Metrics::calls(Op op) const {
+    return ops[(int)op].latency.count();
+}
+
+uint64_t Metrics::failures(Op op, const char* reason) const {
+    uint64_t n = 0;
+    for (auto &r : ops[(int)op].reasons) {
+        const char* have = r.name.load(std::memory_order_acquire);
+        if (have && (!reason || std::strcmp(have, reason) == 0)) n += r.n.load(std::memory_order_relaxed);
+    }
+    return n;
+}
+
+std::vector<std::string> Metrics::dump() const {
+    std::vector<std::string> rows;
+    char buf[160];
+    for (int i = 0; i < (int)Op::COUNT; ++i) {
+        const OpStats &s = ops[i];
+        if (s.latency.count() == 0) continue;
+        std::snprintf(buf, sizeof buf, "%s|%llu|%llu|%.1f|%.1f|%.1f|", name((Op)i),
+                      (unsigned long long)s.latency.count(), (unsigned long long)failures((Op)i),
+                      s.latency.percentile(0.5) / 1e3, s.latency.percentile(0.99) / 1e3, s.latency.max() / 1e3);
+        std::string row = buf;
+        bool first = true;
+        for (auto &r : s.reasons) {
+            const char* reason = r.name.load(std::memory_order_acquire);
+            uint64_t n = r.n.load(std::memory_order_relaxed);
+            if (!reason || n == 0) continue;
+            row += (first ? "" : ",") + std::string(reason) + "=" + std::to_string(n);
+            first = false;
+        }
+        rows.push_back(row);
+    }
+    return rows;
+}
+
+void Metrics::writePrometheus(std::ostream& out) const {
+    static const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+    char buf[64];
+    auto seconds = [&buf](uint64_t ns) {
+        std::snprintf(buf, sizeof buf, "%.9g", ns / 1e9);
+        return buf;
+    };
+    out << "# HELP store_operation_duration_seconds Latency of store, bank and persistence operations.\n"
+           "# TYPE store_operation_duration_seconds summary\n";
+    for (int i = 0; i < (int)Op::COUNT; ++i) {
+        const Histogram &h = ops[i].latency;
+        std::string label = std::string("op=\"") + name((Op)i) + "\"";
+        for (double q : quantiles)
+            out << "store_operation_duration_seconds{" << label << ",quantile=\"" << q << "\"} "
+                << seconds(h.percentile(q)) << "\n";
+        out << "store_operation_duration_seconds_sum{" << label << "} " << seconds(h.sum()) << "\n";
+        out << "store_operation_duration_seconds_count{" << label << "} " << h.count() << "\n";
+    }
+    out << "# HELP store_operation_max_seconds Slowest call of each operation.\n"
+           "# TYPE store_operation_max_seconds gauge\n";
+    for (int i = 0; i < (int)Op::COUNT; ++i)
+        out << "store_operation_max_seconds{op=\"" << name((Op)i) << "\"} " << seconds(ops[i].latency.max()) << "\n";
+    out << "# HELP store_operation_outcomes_total Operation outcomes, \"ok\" or the failure reason.\n"
+           "# TYPE store_operation_outcomes_total counter\n";
+    for (int i = 0; i < (int)Op::COUNT; ++i) {
+        const OpStats &s = ops[i];
+        out << "store_operation_outcomes_total{op=\"" << name((Op)i) << "\",outcome=\"ok\"} "
+            << s.ok.load(std::memory_order_relaxed) << "\n";
+        for (auto &r : s.reasons) {
+            const char* reason = r.name.load(std::memory_order_acquire);
+            if (reason)
+                out << "store_operation_outcomes_total{op=\"" << name((Op)i) << "\",outcome=\"" << reason << "\"} "
+                    << r.n.load(std::memory_order_relaxed) << "\n";
+        }
+    }
+}
+
+bool Metrics::writePrometheusFile(const std::string& path) const {
+    // scrapers (e.g. a textfile collector) must never see a half-written file
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::trunc);
+        if (!f) return false;
+        writePrometheus(f);
+        if (!f.flush()) return false;
+    }
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
@@ -0,0 +1,130 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Process-wide operation metrics: per operation a call count, a latency histogram and
+// failure counts by reason. Recording is a clock read at each end plus a few relaxed
+// atomic adds. Building with -DSTORE_NO_METRICS (every translation unit alike) compiles
+// the recording calls to nothing; the exports then report no calls.
+enum class Op {
+    PURCHASE, PURCHASE_BATCH, LOGIN, REGISTER, ADD_ITEM, UPDATE_ITEM,
+    COMPLETE, CANCEL, COMPLETE_PENDING, LIST_ITEMS, SEARCH_ITEMS,
+    REPORT_TRANSACTIONS, REPORT_PAID, REPORT_TOP_ITEMS, REPORT_SPENDING, REPORT_ACTIVE_USERS,
+    DEPOSIT, WITHDRAW, BANK_REPORT,
+    LOAD_STORE, SAVE_STORE, LOAD_SNAPSHOT, SAVE_SNAPSHOT, CHECKPOINT, WAL_REPLAY, WAL_FLUSH,
+    COUNT
+};
+
+// Log-linear latency histogram (HDR-style): exact below 16 ns, then 16 linear buckets per
+// power of two, so a reported value is within 1/16 of the recorded one. Thread-safe.
+class Histogram {
+public:
+    void record(uint64_t ns);
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return sumNs.load(std::memory_order_relaxed); }
+    uint64_t max() const { return maxNs.load(std::memory_order_relaxed); }
+    uint64_t percentile(double q) const; // upper bound of the bucket holding quantile q (0..1)
+    void reset();
+
+    static const int kSubBits = 4;
+    static const int kMaxBits = 40; // larger values (over ~18 minutes) land in the last bucket
+    static const int kBuckets = (1 << kSubBits) * (kMaxBits - kSubBits + 2);
+    static int bucketOf(uint64_t ns);
+    static uint64_t bucketTop(int b);
+
+private:
+    std::atomic<uint64_t> buckets[kBuckets] = {};
+    std::atomic<uint64_t> total{0}, sumNs{0}, maxNs{0};
+};
+
+class Metrics {
+public:
+    // Reasons are string literals; each operation keeps up to kMaxReasons distinct ones
+    // (later ones are counted under the last).
+    void record(Op op, uint64_t ns, const char* failure = nullptr) { // one call
+        recordLatency(op, ns);
+        count(op, failure);
+    }
+    void recordLatency(Op op, uint64_t ns) { // one call, outcomes counted separately
+#ifndef STORE_NO_METRICS
+        ops[(int)op].latency.record(ns);
+#else
+        (void)op, (void)ns;
+#endif
+    }
+    void count(Op op, const char* failure = nullptr) { // one outcome (nullptr = success)
+#ifndef STORE_NO_METRICS
+        if (!failure) ops[(int)op].ok.fetch_add(1, std::memory_order_relaxed);
+        else addFailure(op, failure);
+#else
+        (void)op, (void)failure;
+#endif
+    }
+    void reset();
+
+    uint64_t calls(Op op) const;
+    uint64_t failures(Op op, const char* reason = nullptr) const; // nullptr = all reasons
+    const Histogram& latency(Op op) const { return ops[(int)op].latency; }
+
+    // "op|calls|failures|p50_us|p99_us|max_us|reason=n,..." per operation that ran
+    std::vector<std::string> dump() const;
+    // Prometheus text exposition format: a summary of latencies and a counter of outcomes.
+    void writePrometheus(std::ostream& out) const;
+    bool writePrometheusFile(const std::string& path) const; // written aside, then renamed
+
+    static const char* name(Op op);
+    static const int kMaxReasons = 8;
+
+private:
+    struct Reason {
+        std::atomic<const char*> name{nullptr};
+        std::atomic<uint64_t> n{0};
+    };
+    struct OpStats {
+        std::atomic<uint64_t> ok{0};
+        Reason reasons[kMaxReasons];
+        Histogram latency;
+    };
+    void addFailure(Op op, const char* reason);
+    OpStats ops[(int)Op::COUNT];
+};
+
+Metrics& metrics();
+
+// Times a scope and records it as one call of `op` when it ends; fail() marks the call
+// failed (the last reason wins) and returns false, for `return t.fail("reason");`.
+class OpTimer {
+public:
+#ifndef STORE_NO_METRICS
+    explicit OpTimer(Op o) : op(o), start(std::chrono::steady_clock::now()) {}
+    ~OpTimer() {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        if (counted) metrics().record(op, (uint64_t)ns.count(), reason);
+        else metrics().recordLatency(op, (uint64_t)ns.count());
+    }
+    bool fail(const char* why) { reason = why; return false; }
+    void outcomesCountedSeparately() { counted = false; } // e.g. one outcome per batch line
+#else
+    explicit OpTimer(Op) {}
+    bool fail(const char*) { return false; }
+    void outcomesCountedSeparately() {}
+#endif
+    OpTimer(const OpTimer&) = delete;
+    OpTimer& operator=(const OpTimer&) = delete;
+
+#ifndef STORE_NO_METRICS
+private:
+    Op op;
+    std::chrono::steady_clock::time_point start;
+    const char* reason = nullptr;
+    bool counted = true;
+#endif
+};
+
+#endif // METRICS_H
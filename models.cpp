@@ -1,34 +1,68 @@
 #include "models.h"
 #include <algorithm>
 
-BankAccount::BankAccount(const std::string& id, const std::string& owner, double initial)
+BankAccount::BankAccount(const std::string& id, const std::string& owner, Money initial)
     : accountID(id), ownerName(owner), balance(initial) {}
 
-void BankAccount::deposit(double amount, const std::string& date, const std::string& note) {
+void BankAccount::deposit(Money amount, Date date, Sym note) {
     balance += amount;
-    txs.push_back({date, amount, note});
+    record({date, amount, note});
 }
 
-bool BankAccount::withdraw(double amount, const std::string& date, const std::string& note) {
+bool BankAccount::withdraw(Money amount, Date date, Sym note) {
     if (amount > balance) return false;
     balance -= amount;
-    txs.push_back({date, -amount, note});
+    record({date, -amount, note});
     return true;
 }
 
-std::string BankAccount::lastTransactionDate() const {
-    if (txs.empty()) return "";
-    return txs.back().date;
+void BankAccount::record(const BankTx& tx) {
+    if (!txs.empty() && tx.date < lastDay) datesInOrder = false;
+    if (txs.empty() || tx.date > lastDay) lastDay = tx.date;
+    txs.push_back(tx);
+
+    if (cached.asOf == Date()) return;
+    int age = cached.asOf - tx.date;
+    if (age < 0) { cached.asOf = Date(); return; } // dated past the cached day: recompute on next read
+    if (age == 0) ++cached.todayCount;
+    if (age <= 7) (tx.amount >= Money() ? cached.in7 : cached.out7) += tx.amount.abs();
+    if (age <= 30) (tx.amount >= Money() ? cached.in30 : cached.out30) += tx.amount.abs();
+}
+
+const AccountSummary& BankAccount::summary(Date today) const {
+    if (cached.asOf == today) return cached;
+    cached = AccountSummary();
+    cached.asOf = today;
+    for (auto it = txs.rbegin(); it != txs.rend(); ++it) {
+        int age = today - it->date;
+        if (age > 30) {
+            if (datesInOrder) break;
+            continue;
+        }
+        if (age < 0) continue;
+        if (age == 0) ++cached.todayCount;
+        if (age <= 7) (it->amount >= Money() ? cached.in7 : cached.out7) += it->amount.abs();
+        (it->amount >= Money() ? cached.in30 : cached.out30) += it->amount.abs();
+    }
+    return cached;
+}
+
+void BankAccount::resync() {
+    lastDay = Date();
+    datesInOrder = true;
+    for (size_t i = 0; i < txs.size(); ++i) {
+        if (i > 0 && txs[i].date < txs[i - 1].date) datesInOrder = false;
+        if (i == 0 || txs[i].date > lastDay) lastDay = txs[i].date;
+    }
+    cached = AccountSummary();
 }
 
-Transaction::Transaction(const std::string& tid, const std::string& d,
-                         const std::string& bid, const std::string& sid,
-                         const std::string& iid, const std::string& iname,
-                         int qty, double price, TransactionStatus s)
+Transaction::Transaction(Sym tid, Date d, Sym bid, Sym sid, Sym iid, Sym iname,
+                         int qty, Money price, TransactionStatus s)
     : transactionID(tid), date(d), buyerID(bid), sellerID(sid),
       itemID(iid), itemName(iname), quantity(qty), totalPrice(price), status(s) {}
 
-Item::Item(const std::string& id, const std::string& n, double p, int s)
+Item::Item(const std::string& id, const std::string& n, Money p, int s)
     : itemID(id), name(n), price(p), stock(s), soldCount(0) {}
 
 bool Item::canSell(int qty) const {
@@ -46,12 +80,17 @@ void Item::replenish(int qty) {
     stock += qty;
 }
 
+void Item::restock(int qty) {
+    stock += qty;
+    soldCount = std::max(0, soldCount - qty);
+}
+
 void Item::discard(int qty) {
     stock = std::max(0, stock - qty);
 }
 
 User::User(const std::string& id, const std::string& uname, const std::string& pass, const std::string& r)
-    : userID(id), username(uname), password(pass), role(r), account(id, uname, 0.0) {}
+    : userID(id), username(uname), password(pass), role(r), account(id, uname) {}
 
 Buyer::Buyer(const std::string& id, const std::string& uname, const std::string& pass)
     : User(id, uname, pass, "buyer") {}
@@ -1,66 +1,91 @@
 #ifndef MODELS_H
 #define MODELS_H
 
+#include <memory_resource>
 #include <string>
 #include <vector>
-#include <ctime>
+#include "date.h"
+#include "money.h"
+#include "record_pool.h"
+#include "symbol.h"
 
 enum class TransactionStatus { PAID, COMPLETED, CANCELED };
 
+// 16 bytes: day number, amount, interned note.
 struct BankTx {
-    std::string date; // YYYY-MM-DD
-    double amount;    // + deposit, - withdraw
-    std::string note;
+    Date date;
+    Money amount;     // + deposit, - withdraw
+    Sym note;         // notes repeat ("purchase", "sale", ...): interned
+};
+
+// Totals over an account's txs for the windows ending on day asOf.
+struct AccountSummary {
+    Date asOf;                   // epoch: not computed yet
+    int todayCount = 0;          // txs dated asOf
+    Money in7, out7;             // deposits / withdrawals dated asOf-7 .. asOf
+    Money in30, out30;           // same over asOf-30 .. asOf
 };
 
 class BankAccount {
 public:
     std::string accountID;
     std::string ownerName;
-    double balance;
-    std::vector<BankTx> txs;
+    Money balance;
+    std::pmr::vector<BankTx> txs{recordPool()};
+    Date lastDay;              // latest tx date, epoch if none
+    bool datesInOrder = true;  // txs sorted by date, so window scans can stop early
 
     BankAccount() = default;
-    BankAccount(const std::string& id, const std::string& owner, double initial = 0.0);
+    BankAccount(const std::string& id, const std::string& owner, Money initial = Money());
+
+    void deposit(Money amount, Date date, Sym note = Sym());
+    bool withdraw(Money amount, Date date, Sym note = Sym());
+    Date lastTransactionDate() const { return lastDay; } // epoch if none
 
-    void deposit(double amount, const std::string& date, const std::string& note = "");
-    bool withdraw(double amount, const std::string& date, const std::string& note = "");
-    std::string lastTransactionDate() const; // returns "" if none
+    // Cached, so reports don't rescan history: deposit/withdraw keep it current and it
+    // is recomputed once when asked for a later day. Caller holds the account's lock.
+    const AccountSummary& summary(Date today) const;
+    void resync(); // after txs was filled directly (loaders): recompute lastDay / order, drop the cache
+
+private:
+    void record(const BankTx& tx);
+    mutable AccountSummary cached;
 };
 
+// IDs and the item name are interned: each repeats across many transactions
+// (and the ID again in Buyer::orderIDs / Seller::saleTxIDs).
 struct Transaction {
-    std::string transactionID;
-    std::string date; // YYYY-MM-DD
-    std::string buyerID;
-    std::string sellerID;
-    std::string itemID;
-    std::string itemName;
+    Sym transactionID;
+    Date date;
+    Sym buyerID;
+    Sym sellerID;
+    Sym itemID;
+    Sym itemName;
     int quantity;
-    double totalPrice;
+    Money totalPrice;
     TransactionStatus status;
 
     Transaction() = default;
-    Transaction(const std::string& tid, const std::string& d,
-                const std::string& bid, const std::string& sid,
-                const std::string& iid, const std::string& iname,
-                int qty, double price, TransactionStatus s);
+    Transaction(Sym tid, Date d, Sym bid, Sym sid, Sym iid, Sym iname,
+                int qty, Money price, TransactionStatus s);
 };
 
 class Item {
 public:
     std::string itemID;
     std::string name;
-    double price;
+    Money price;
     int stock;
     int soldCount;
 
     Item() = default;
-    Item(const std::string& id, const std::string& n, double p, int s);
+    Item(const std::string& id, const std::string& n, Money p, int s);
 
     bool canSell(int qty) const;
     bool sell(int qty);
     void replenish(int qty);
     void discard(int qty);
+    void restock(int qty); // undoes sell(qty) for a canceled order
 };
 
 class User {
@@ -77,15 +102,15 @@ public:
 
 class Buyer : public User {
 public:
-    std::vector<std::string> orderIDs; // store transaction IDs
+    std::vector<Sym> orderIDs; // store transaction IDs
     Buyer() = default;
     Buyer(const std::string& id, const std::string& uname, const std::string& pass);
 };
 
 class Seller : public User {
 public:
-    std::vector<std::string> itemIDs;   // IDs of items owned
-    std::vector<std::string> saleTxIDs; // transaction IDs
+    std::vector<Sym> itemIDs;   // IDs of items owned
+    std::vector<Sym> saleTxIDs; // transaction IDs
     Seller() = default;
     Seller(const std::string& id, const std::string& uname, const std::string& pass);
 };
@@ -0,0 +1,63 @@
+#include "money.h"
+#include <charconv>
+#include <cmath>
+#include <ostream>
+
+Money Money::fromDouble(double units) {
+    return Money((int64_t)std::llround(units * 100));
+}
+
+bool Money::tryParse(const char* s, std::size_t len, Money& out) {
+    // fast exact path: [-]digits[.d[d]]
+    const char* p = s;
+    const char* end = s + len;
+    bool neg = p != end && *p == '-';
+    if (neg) ++p;
+    const char* digits = p;
+    int64_t units = 0;
+    while (p != end && *p >= '0' && *p <= '9' && p - digits < 16) units = units * 10 + (*p++ - '0');
+    bool anyDigits = p != digits;
+    int64_t frac = 0;
+    int fracDigits = 0;
+    if (p != end && *p == '.') {
+        ++p;
+        while (p != end && *p >= '0' && *p <= '9' && fracDigits < 2) {
+            frac = frac * 10 + (*p++ - '0');
+            ++fracDigits;
+        }
+        anyDigits = anyDigits || fracDigits > 0;
+    }
+    if (p == end && anyDigits) {
+        if (fracDigits == 1) frac *= 10;
+        out = Money(neg ? -(units * 100 + frac) : units * 100 + frac);
+        return true;
+    }
+    // anything else (exponents, longer fractions) was written as a double: round it
+    double v = 0;
+    auto r = std::from_chars(s, end, v);
+    if (r.ec != std::errc() || r.ptr != end) return false;
+    out = fromDouble(v);
+    return true;
+}
+
+Money Money::parse(const std::string& s) {
+    Money m;
+    tryParse(s.data(), s.size(), m);
+    return m;
+}
+
+std::string Money::str() const {
+    uint64_t mag = cents < 0 ? 0 - (uint64_t)cents : (uint64_t)cents;
+    std::string out = cents < 0 ? "-" : "";
+    out += std::to_string(mag / 100);
+    if (uint64_t frac = mag % 100) {
+        out += '.';
+        out += (char)('0' + frac / 10);
+        out += (char)('0' + frac % 10);
+    }
+    return out;
+}
+
+std::ostream& operator<<(std::ostream& os, Money m) {
+    return os << m.str();
+}
@@ -0,0 +1,44 @@
+#ifndef MONEY_H
+#define MONEY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+// Amount of money as a whole number of minor units (cents), so sums are exact and
+// the text form round-trips. Text form is units with two decimals ("12.30"), or
+// plain units when there is no fraction ("50").
+struct Money {
+    int64_t cents = 0;
+
+    Money() = default;
+    explicit Money(int64_t c) : cents(c) {}
+
+    static Money units(int64_t u) { return Money(u * 100); }
+    static Money fromDouble(double units); // rounds to the nearest cent (old data, user input)
+    static bool tryParse(const char* s, std::size_t len, Money& out);
+    static Money parse(const std::string& s); // zero on malformed input
+
+    std::string str() const;
+    double toDouble() const { return cents / 100.0; } // for ratios and display only
+    Money abs() const { return Money(cents < 0 ? -cents : cents); }
+
+    Money operator+(Money o) const { return Money(cents + o.cents); }
+    Money operator-(Money o) const { return Money(cents - o.cents); }
+    Money operator-() const { return Money(-cents); }
+    Money operator*(int64_t n) const { return Money(cents * n); }
+    Money& operator+=(Money o) { cents += o.cents; return *this; }
+    Money& operator-=(Money o) { cents -= o.cents; return *this; }
+
+    bool operator==(Money o) const { return cents == o.cents; }
+    bool operator!=(Money o) const { return cents != o.cents; }
+    bool operator<(Money o) const { return cents < o.cents; }
+    bool operator<=(Money o) const { return cents <= o.cents; }
+    bool operator>(Money o) const { return cents > o.cents; }
+    bool operator>=(Money o) const { return cents >= o.cents; }
+};
+
+std::ostream& operator<<(std::ostream& os, Money m);
+
+#endif // MONEY_H
@@ -0,0 +1,25 @@
+#include "record_pool.h"
+#include <atomic>
+
+namespace {
+std::atomic<bool> pooling{true};
+}
+
+std::pmr::memory_resource* recordPool() {
+    if (!pooling.load(std::memory_order_relaxed)) return std::pmr::new_delete_resource();
+    // never destroyed: records may be freed during static teardown
+    static std::pmr::synchronized_pool_resource* pool = [] {
+        std::pmr::pool_options opts;
+        opts.largest_required_pool_block = 64 * 1024; // a 4096-entry history still pools
+        return new std::pmr::synchronized_pool_resource(opts);
+    }();
+    return pool;
+}
+
+void setRecordPooling(bool on) {
+    pooling.store(on, std::memory_order_relaxed);
+}
+
+bool recordPooling() {
+    return pooling.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,16 @@
+#ifndef RECORD_POOL_H
+#define RECORD_POOL_H
+
+#include <memory_resource>
+
+// Memory for the high-volume records: bank histories (BankAccount::txs) and the
+// transaction table's nodes. When pooling is on (the default) they come from one
+// process-wide, thread-safe pool of size-classed blocks, so growing a history or
+// adding a transaction reuses freed blocks instead of going to malloc each time.
+// Containers pick the resource when they are constructed: switch pooling before
+// creating the Bank/Store it should apply to.
+std::pmr::memory_resource* recordPool();
+void setRecordPooling(bool on);
+bool recordPooling();
+
+#endif // RECORD_POOL_H
@@ -0,0 +1,298 @@
+#include "server.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+struct Server::Connection {
+    int fd;
+    uint32_t events = 0;   // registered with epoll (loop thread only)
+    bool registered = false;
+    bool eof = false;      // peer finished sending (loop thread only)
+    bool closed = false;   // (loop thread only)
+    std::string in;        // bytes after the last complete line (loop thread only)
+    BatchSession session;  // used by the worker holding `busy`
+
+    std::mutex mu;         // guards the fields below
+    std::string requests;  // complete lines waiting for a worker
+    std::string out;       // responses not yet written
+    bool busy = false;     // a worker is running this connection's requests
+    bool quit = false;     // "quit" ran: close once out is written
+
+    explicit Connection(int f) : fd(f) {}
+};
+
+Server::Server(Store& store, size_t workers) : exec(store), nWorkers(workers ? workers : 1) {
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+}
+
+Server::~Server() {
+    for (auto &p : conns) ::close(p.first);
+    if (listenFd >= 0) ::close(listenFd);
+    if (wakeFd >= 0) ::close(wakeFd);
+    if (epollFd >= 0) ::close(epollFd);
+    if (!unixPath.empty()) ::unlink(unixPath.c_str());
+}
+
+bool Server::listen(const std::string& address) {
+    if (address.compare(0, 5, "unix:") == 0) {
+        sockaddr_un sa{};
+        sa.sun_family = AF_UNIX;
+        std::string path = address.substr(5);
+        if (path.empty() || path.size() >= sizeof(sa.sun_path)) return false;
+        std::memcpy(sa.sun_path, path.c_str(), path.size() + 1);
+        listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        ::unlink(path.c_str());
+        if (listenFd < 0 || bind(listenFd, (sockaddr*)&sa, sizeof(sa)) != 0) return false;
+        unixPath = path;
+    } else {
+        size_t colon = address.rfind(':');
+        std::string host = colon == std::string::npos ? "127.0.0.1" : address.substr(0, colon);
+        sockaddr_in sa{};
+        sa.sin_family = AF_INET;
+        sa.sin_port = htons((uint16_t)std::atoi(address.c_str() + (colon == std::string::npos ? 0 : colon + 1)));
+        if (inet_pton(AF_INET, host.c_str(), &sa.sin_addr) != 1) return false;
+        listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int one = 1;
+        if (listenFd < 0) return false;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (bind(listenFd, (sockaddr*)&sa, sizeof(sa)) != 0) return false;
+        socklen_t len = sizeof(sa);
+        getsockname(listenFd, (sockaddr*)&sa, &len);
+        boundPort = ntohs(sa.sin_port);
+    }
+    if (::listen(listenFd, SOMAXCONN) != 0) return false;
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = listenFd;
+    return epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev) == 0;
+}
+
+void Server::stop() {
+    stopping.store(true);
+    wake();
+}
+
+void Server::wake() {
+    uint64_t one = 1;
+    ssize_t r = ::write(wakeFd, &one, sizeof(one));
+    (void)r; // a full counter already means a pending wake-up
+}
+
+void Server::run(const std::function<void()>& maintenance) {
+    for (size_t i = 0; i < nWorkers; ++i) pool.emplace_back(&Server::work, this);
+    using Clock = std::chrono::steady_clock;
+    auto nextMaintenance = Clock::now() + std::chrono::seconds(1);
+    epoll_event evs[256];
+    while (!stopping.load()) {
+        int n = epoll_wait(epollFd, evs, 256, 200);
+        for (int i = 0; i < n; ++i) {
+            int fd = evs[i].data.fd;
+            if (fd == listenFd) { acceptAll(); continue; }
+            if (fd == wakeFd) {
+                uint64_t v;
+                while (::read(wakeFd, &v, sizeof(v)) > 0) {}
+                continue;
+            }
+            auto it = conns.find(fd);
+            if (it == conns.end()) continue;
+            ConnPtr c = it->second; // keep alive across close()
+            // hang-up/error: the peer can no longer read answers (a half-close is EPOLLIN + eof)
+            if (evs[i].events & (EPOLLHUP | EPOLLERR)) { close(c); continue; }
+            if (evs[i].events & EPOLLIN) readFrom(c);
+            if (!c->closed && (evs[i].events & EPOLLOUT)) flush(c);
+        }
+        std::vector<ConnPtr> done;
+        {
+            std::lock_guard<std::mutex> lk(readyMu);
+            done.swap(ready);
+        }
+        for (auto &c : done)
+            if (!c->closed) flush(c);
+
+        if (maintenance && Clock::now() >= nextMaintenance) {
+            std::unique_lock<std::mutex> lk(gateMu);
+            paused = true;
+            gateCv.wait(lk, [this] { return running == 0; });
+            maintenance();
+            paused = false;
+            lk.unlock();
+            gateCv.notify_all();
+            nextMaintenance = Clock::now() + std::chrono::seconds(1);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(taskMu);
+        tasks.clear();
+    }
+    taskCv.notify_all();
+    for (auto &t : pool) t.join();
+    pool.clear();
+    std::vector<ConnPtr> open;
+    for (auto &p : conns) open.push_back(p.second);
+    for (auto &c : open) close(c);
+}
+
+void Server::acceptAll() {
+    for (;;) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return; // EAGAIN, or a transient error: epoll reports the next one
+        if (unixPath.empty()) {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+        auto c = std::make_shared<Connection>(fd);
+        conns[fd] = c;
+        updateEvents(c, false, false);
+    }
+}
+
+void Server::updateEvents(const ConnPtr& c, bool wantOut, bool throttle) {
+    // stop reading from a peer that doesn't read its responses, and after its EOF
+    bool wantIn = !c->eof && !throttle;
+    uint32_t events = (wantIn ? (uint32_t)EPOLLIN : 0u) | (wantOut ? (uint32_t)EPOLLOUT : 0u);
+    if (c->registered && events == c->events) return;
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.fd = c->fd;
+    epoll_ctl(epollFd, c->registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, c->fd, &ev);
+    c->events = events;
+    c->registered = true;
+}
+
+void Server::readFrom(const ConnPtr& c) {
+    char buf[1 << 16];
+    for (;;) {
+        ssize_t n = ::read(c->fd, buf, sizeof(buf));
+        if (n > 0) {
+            c->in.append(buf, n);
+            continue;
+        }
+        if (n == 0) c->eof = true;
+        else if (errno == EINTR) continue;
+        else if (errno != EAGAIN && errno != EWOULDBLOCK) { close(c); return; }
+        break;
+    }
+    if (c->eof && !c->in.empty() && c->in.back() != '\n') c->in += '\n'; // unterminated last line
+    size_t last = c->in.rfind('\n');
+    if (last == std::string::npos) {
+        if (c->in.size() > kMaxLine) { close(c); return; }
+    } else {
+        bool start;
+        {
+            std::lock_guard<std::mutex> lk(c->mu);
+            c->requests.append(c->in, 0, last + 1);
+            start = !c->busy;
+            c->busy = true;
+        }
+        c->in.erase(0, last + 1);
+        if (start) submit(c);
+    }
+    if (c->eof) flush(c); // closes once everything sent has been answered
+}
+
+void Server::flush(const ConnPtr& c) {
+    std::unique_lock<std::mutex> lk(c->mu);
+    size_t sent = 0;
+    while (sent < c->out.size()) {
+        ssize_t n = ::send(c->fd, c->out.data() + sent, c->out.size() - sent, MSG_NOSIGNAL);
+        if (n > 0) { sent += n; continue; }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        lk.unlock();
+        close(c);
+        return;
+    }
+    c->out.erase(0, sent);
+    bool pendingOut = !c->out.empty();
+    bool throttle = c->out.size() >= kMaxPending;
+    bool finished = !pendingOut && !c->busy && (c->quit || (c->eof && c->requests.empty()));
+    lk.unlock();
+    if (finished) close(c);
+    else updateEvents(c, pendingOut, throttle);
+}
+
+void Server::close(const ConnPtr& c) {
+    if (c->closed) return;
+    c->closed = true;
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, c->fd, nullptr);
+    ::close(c->fd);
+    conns.erase(c->fd);
+}
+
+void Server::submit(const ConnPtr& c) {
+    {
+        std::lock_guard<std::mutex> lk(taskMu);
+        tasks.push_back(c);
+    }
+    taskCv.notify_one();
+}
+
+void Server::work() {
+    std::string batch, out;
+    for (;;) {
+        ConnPtr c;
+        {
+            std::unique_lock<std::mutex> lk(taskMu);
+            taskCv.wait(lk, [this] { return stopping.load() || !tasks.empty(); });
+            if (stopping.load()) return;
+            c = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        {
+            std::lock_guard<std::mutex> lk(c->mu);
+            batch.swap(c->requests);
+        }
+        {
+            std::unique_lock<std::mutex> lk(gateMu);
+            gateCv.wait(lk, [this] { return !paused; });
+            ++running;
+        }
+        bool more = true;
+        for (size_t pos = 0; more && pos < batch.size();) {
+            size_t nl = batch.find('\n', pos);
+            more = exec.execute(std::string_view(batch).substr(pos, nl - pos), c->session, out);
+            pos = nl + 1;
+        }
+        bool last;
+        {
+            std::lock_guard<std::mutex> lk(gateMu);
+            last = --running == 0 && paused;
+        }
+        if (last) gateCv.notify_all();
+
+        // one batch per turn: lines that arrived meanwhile go behind the other connections
+        bool again;
+        {
+            std::lock_guard<std::mutex> lk(c->mu);
+            c->out += out;
+            c->quit = c->quit || !more;
+            again = !c->requests.empty() && !c->quit;
+            if (!again) {
+                c->requests.clear();
+                c->busy = false;
+            }
+        }
+        batch.clear();
+        out.clear();
+        if (again) submit(c);
+        {
+            std::lock_guard<std::mutex> lk(readyMu);
+            ready.push_back(std::move(c));
+        }
+        wake();
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "batch.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Serves BatchExecutor commands (batch.h) on a local socket: one command per line,
+// responses in request order on each connection, so clients may pipeline.
+// One thread multiplexes every connection with epoll; a worker pool runs the commands,
+// at most one worker per connection at a time (its requests run in order, in one session).
+// An "ok" is sent once the mutation is logged, not once it is fsynced: see WriteAheadLog.
+class Server {
+public:
+    Server(Store& store, size_t workers);
+    ~Server();
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    bool listen(const std::string& address); // "PORT", "HOST:PORT" (TCP) or "unix:PATH"
+    uint16_t port() const { return boundPort; } // TCP port actually bound (for "0")
+
+    // Serves until stop(). `maintenance` runs on the loop thread about once a second while
+    // no command is executing (WAL checkpoints need the store to themselves).
+    void run(const std::function<void()>& maintenance = {});
+    void stop(); // async-signal-safe
+
+    static const size_t kMaxLine = 1 << 16;    // longer requests close the connection
+    static const size_t kMaxPending = 1 << 22; // unsent response bytes before reading pauses
+
+private:
+    struct Connection;
+    using ConnPtr = std::shared_ptr<Connection>;
+
+    void acceptAll();
+    void readFrom(const ConnPtr& c);
+    void flush(const ConnPtr& c);
+    void close(const ConnPtr& c);
+    void updateEvents(const ConnPtr& c, bool wantOut, bool throttle);
+    void submit(const ConnPtr& c);
+    void work();
+    void wake();
+
+    BatchExecutor exec;
+    size_t nWorkers;
+    int listenFd = -1, epollFd = -1, wakeFd = -1;
+    uint16_t boundPort = 0;
+    std::string unixPath;
+    std::atomic<bool> stopping{false};
+    std::unordered_map<int, ConnPtr> conns; // loop thread only
+
+    std::mutex taskMu; // connections with requests for a worker
+    std::condition_variable taskCv;
+    std::deque<ConnPtr> tasks;
+
+    std::mutex readyMu; // connections with new responses for the loop to write
+    std::vector<ConnPtr> ready;
+
+    // maintenance waits for running workers to leave and keeps new ones out
+    std::mutex gateMu;
+    std::condition_variable gateCv;
+    int running = 0;
+    bool paused = false;
+
+    std::vector<std::thread> pool;
+};
+
+#endif // SERVER_H
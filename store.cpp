@@ -1,177 +1,706 @@
 #include "store.h"
-#include <random>
-#include <chrono>
-#include <sstream>
+#include "metrics.h"
 #include <algorithm>
-#include <iomanip>
+#include <charconv>
+#include <cstdint>
 
 void Store::setBank(Bank* b) { bank = b; }
 
+const char* purchaseStatusName(PurchaseStatus s) {
+    switch (s) {
+    case PurchaseStatus::OK: return "ok";
+    case PurchaseStatus::UNKNOWN_BUYER: return "unknown_buyer";
+    case PurchaseStatus::UNKNOWN_ITEM: return "unknown_item";
+    case PurchaseStatus::NO_ACCOUNT: return "no_account";
+    case PurchaseStatus::INVALID_QTY: return "invalid_qty";
+    case PurchaseStatus::OUT_OF_STOCK: return "out_of_stock";
+    case PurchaseStatus::INSUFFICIENT_FUNDS: return "insufficient_funds";
+    case PurchaseStatus::CART_REJECTED: return "cart_rejected";
+    }
+    return "?";
+}
+
 bool Store::registerBuyer(const std::string& id, const std::string& uname, const std::string& pass) {
-    if (buyers.find(id) != buyers.end()) return false;
+    OpTimer t(Op::REGISTER);
+    std::unique_lock<std::shared_mutex> lk(catalogMutex);
+    if (buyers.find(id) != buyers.end()) return t.fail("id_taken");
+    if (usersByName.find(uname) != usersByName.end()) return t.fail("username_taken");
     Buyer b(id, uname, pass);
     buyers[id] = b;
+    usersByName[uname] = &buyers[id];
     // create bank account for user too
-    if (bank) bank->createAccount(id, uname, 0.0);
+    if (bank) bank->createAccount(id, uname);
+    if (wal) wal->append("RB|" + id + "|" + uname + "|" + pass);
     return true;
 }
 
 bool Store::registerSeller(const std::string& id, const std::string& uname, const std::string& pass) {
-    if (sellers.find(id) != sellers.end()) return false;
+    OpTimer t(Op::REGISTER);
+    std::unique_lock<std::shared_mutex> lk(catalogMutex);
+    if (sellers.find(id) != sellers.end()) return t.fail("id_taken");
+    if (usersByName.find(uname) != usersByName.end()) return t.fail("username_taken");
     Seller s(id, uname, pass);
     sellers[id] = s;
-    if (bank) bank->createAccount(id, uname, 0.0);
+    usersByName[uname] = &sellers[id];
+    if (bank) bank->createAccount(id, uname);
+    if (wal) wal->append("RS|" + id + "|" + uname + "|" + pass);
     return true;
 }
 
 User* Store::login(const std::string& username, const std::string& password) {
-    for (auto& [id, b] : buyers) {
-        if (b.username == username && b.password == password)
-            return &b;
+    OpTimer t(Op::LOGIN);
+    std::shared_lock<std::shared_mutex> lk(catalogMutex);
+    auto it = usersByName.find(username);
+    if (it == usersByName.end()) {
+        t.fail("unknown_user");
+        return nullptr;
     }
-    for (auto& [id, s] : sellers) {
-        if (s.username == username && s.password == password)
-            return &s;
+    if (it->second->password != password) {
+        t.fail("bad_password");
+        return nullptr;
     }
-    return nullptr;
+    return it->second;
 }
 
-
 bool Store::addItem(const std::string& sellerID, const std::string& itemID,
-                    const std::string& name, double price, int stock) {
+                    const std::string& name, Money price, int stock) {
+    OpTimer t(Op::ADD_ITEM);
+    std::unique_lock<std::shared_mutex> lk(catalogMutex);
     auto sit = sellers.find(sellerID);
-    if (sit == sellers.end()) return false;
-    if (items.find(itemID) != items.end()) return false;
+    if (sit == sellers.end()) return t.fail("unknown_seller");
+    if (items.find(itemID) != items.end()) return t.fail("item_exists");
     Item it(itemID, name, price, stock);
-    items[itemID] = it;
+    Item &stored = items[itemID] = it;
     sit->second.itemIDs.push_back(itemID);
+    itemOwner[itemID] = sellerID;
+    {
+        std::lock_guard<std::mutex> tlk(txMutex);
+        itemSales.add(itemID, 0);
+    }
+    {
+        std::unique_lock<std::shared_mutex> slk(searchMutex);
+        search.add(&stored);
+    }
+    if (wal) wal->append("AI|" + sellerID + "|" + itemID + "|" + price.str() + "|" + std::to_string(stock) + "|" + name);
     return true;
 }
 
 bool Store::replenishItem(const std::string& sellerID, const std::string& itemID, int qty) {
+    OpTimer t(Op::UPDATE_ITEM);
+    std::shared_lock<std::shared_mutex> lk(catalogMutex);
     auto sit = sellers.find(sellerID);
-    if (sit == sellers.end()) return false;
+    if (sit == sellers.end()) return t.fail("unknown_seller");
     auto it = items.find(itemID);
-    if (it == items.end()) return false;
+    if (it == items.end()) return t.fail("unknown_item");
+    std::lock_guard<std::mutex> ilk(itemLocks.forKey(itemID));
     it->second.replenish(qty);
+    indexStock(it->second);
+    if (wal) wal->append("RI|" + sellerID + "|" + itemID + "|" + std::to_string(qty));
     return true;
 }
 
 bool Store::discardItem(const std::string& sellerID, const std::string& itemID, int qty) {
+    OpTimer t(Op::UPDATE_ITEM);
+    std::shared_lock<std::shared_mutex> lk(catalogMutex);
     auto sit = sellers.find(sellerID);
-    if (sit == sellers.end()) return false;
+    if (sit == sellers.end()) return t.fail("unknown_seller");
     auto it = items.find(itemID);
-    if (it == items.end()) return false;
+    if (it == items.end()) return t.fail("unknown_item");
+    std::lock_guard<std::mutex> ilk(itemLocks.forKey(itemID));
     it->second.discard(qty);
+    indexStock(it->second);
+    if (wal) wal->append("DI|" + sellerID + "|" + itemID + "|" + std::to_string(qty));
     return true;
 }
 
-bool Store::setItemPrice(const std::string& sellerID, const std::string& itemID, double price) {
+bool Store::setItemPrice(const std::string& sellerID, const std::string& itemID, Money price) {
+    OpTimer t(Op::UPDATE_ITEM);
+    std::shared_lock<std::shared_mutex> lk(catalogMutex);
     auto sit = sellers.find(sellerID);
-    if (sit == sellers.end()) return false;
+    if (sit == sellers.end()) return t.fail("unknown_seller");
     auto it = items.find(itemID);
-    if (it == items.end()) return false;
+    if (it == items.end()) return t.fail("unknown_item");
+    std::lock_guard<std::mutex> ilk(itemLocks.forKey(itemID));
     it->second.price = price;
+    {
+        std::unique_lock<std::shared_mutex> slk(searchMutex);
+        search.setPrice(&it->second, price);
+    }
+    if (wal) wal->append("SP|" + sellerID + "|" + itemID + "|" + price.str());
     return true;
 }
 
-bool Store::purchase(const std::string& buyerID, const std::string& itemID, int qty, const std::string& date) {
+bool Store::purchase(const std::string& buyerID, const std::string& itemID, int qty, Date date) {
+    return purchaseWithID(genID("TX"), buyerID, itemID, qty, date);
+}
+
+bool Store::purchaseWithID(const std::string& txid, const std::string& buyerID,
+                           const std::string& itemID, int qty, Date date) {
+    return tryPurchaseWithID(txid, buyerID, itemID, qty, date) == PurchaseStatus::OK;
+}
+
+PurchaseStatus Store::tryPurchaseWithID(const std::string& txid, const std::string& buyerID,
+                                        const std::string& itemID, int qty, Date date) {
+    OpTimer t(Op::PURCHASE);
+    auto fail = [&t](PurchaseStatus s) {
+        t.fail(purchaseStatusName(s));
+        return s;
+    };
+    if (!bank) return fail(PurchaseStatus::NO_ACCOUNT);
+    std::shared_lock<std::shared_mutex> lk(catalogMutex);
     auto bit = buyers.find(buyerID);
+    if (bit == buyers.end()) return fail(PurchaseStatus::UNKNOWN_BUYER);
     auto it = items.find(itemID);
-    if (bit == buyers.end() || it == items.end()) return false;
-    if (!it->second.canSell(qty)) return false;
-    double total = it->second.price * qty;
-
-    // check buyer bank balance
-    if (!bank) return false;
+    auto oit = itemOwner.find(itemID);
+    if (it == items.end() || oit == itemOwner.end()) return fail(PurchaseStatus::UNKNOWN_ITEM);
+    if (qty <= 0) return fail(PurchaseStatus::INVALID_QTY);
+    Sym sellerOfItem = oit->second;
+    auto sit = sellers.find(sellerOfItem.str());
     BankAccount* ba = bank->getAccount(buyerID);
-    BankAccount* sa = bank->getAccount(it->second.itemID); // no, seller account is sellerID, not itemID
-    // find seller id: item -> which seller? We don't store reverse mapping efficiently; scan sellers
-    std::string sellerOfItem;
-    for (auto &p : sellers) {
-        auto &vec = p.second.itemIDs;
-        if (std::find(vec.begin(), vec.end(), itemID) != vec.end()) {
-            sellerOfItem = p.first;
-            break;
-        }
-    }
-    if (sellerOfItem.empty()) return false;
-    sa = bank->getAccount(sellerOfItem);
-    if (!ba || !sa) return false;
-    if (ba->balance < total) return false;
+    BankAccount* sa = bank->getAccount(sellerOfItem);
+    if (sit == sellers.end() || !ba || !sa) return fail(PurchaseStatus::NO_ACCOUNT);
 
-    // withdraw from buyer, deposit to seller
-    if (!bank->withdraw(buyerID, total, date, std::string("purchase ") + itemID)) return false;
-    bank->deposit(sellerOfItem, total, date, std::string("sale ") + itemID);
+    // check stock and balance, then move money and stock, all under the item + both account stripes
+    MultiLock rec{&itemLocks.forKey(itemID),
+                  &bank->accountLocks.forKey(buyerID),
+                  &bank->accountLocks.forKey(sellerOfItem)};
+    if (!it->second.canSell(qty)) return fail(PurchaseStatus::OUT_OF_STOCK);
+    Money total = it->second.price * qty;
+    if (ba->balance < total) return fail(PurchaseStatus::INSUFFICIENT_FUNDS);
+
+    // withdraw from buyer, deposit to seller (straight on the accounts: the purchase record covers both in the WAL)
+    if (!ba->withdraw(total, date, std::string("purchase ") + itemID)) return fail(PurchaseStatus::INSUFFICIENT_FUNDS);
+    sa->deposit(total, date, std::string("sale ") + itemID);
 
     // update item sold
     it->second.sell(qty);
+    indexStock(it->second);
+
+    // logged before the order becomes visible: a complete or cancel can only reach the log after it
+    if (wal) wal->append("PU|" + txid + "|" + buyerID + "|" + itemID + "|" + std::to_string(qty) + "|" + std::to_string(date.day));
 
     // create transaction
-    std::string txid = genID("TX");
-    Transaction tx(txid, date, buyerID, sellerOfItem, itemID, it->second.name, qty, total, TransactionStatus::PAID);
-    transactions[txid] = tx;
+    noteID(txid);
+    Sym tid(txid);
+    Transaction tx(tid, date, bit->first, sellerOfItem, it->first, it->second.name, qty, total, TransactionStatus::PAID);
+    {
+        std::lock_guard<std::mutex> tlk(txMutex);
+        Transaction &stored = transactions[tid] = tx;
+        txByDay[date].push_back(&stored);
+        indexPaid(stored);
+        itemSales.add(tx.itemID, qty);
+        buyerActivity.add(date, tx.buyerID);
+        sellerActivity.add(date, tx.sellerID);
+    }
+    bank->noteActivity(*ba, date);
+    bank->noteActivity(*sa, date);
 
     // record in buyer/seller
-    bit->second.orderIDs.push_back(txid);
-    sellers[sellerOfItem].saleTxIDs.push_back(txid);
+    bit->second.orderIDs.push_back(tid);
+    sit->second.saleTxIDs.push_back(tid);
+    return PurchaseStatus::OK;
+}
 
-    return true;
+std::vector<PurchaseResult> Store::purchaseBatch(const std::vector<PurchaseLine>& lines, Date date) {
+    std::vector<std::string> txids;
+    txids.reserve(lines.size());
+    for (size_t i = 0; i < lines.size(); ++i) txids.push_back(genID("TX"));
+    return purchaseBatchWithIDs(lines, txids, date);
+}
+
+std::vector<PurchaseResult> Store::purchaseBatchWithIDs(const std::vector<PurchaseLine>& lines,
+                                                        const std::vector<std::string>& txids, Date date) {
+    OpTimer timer(Op::PURCHASE_BATCH);
+    timer.outcomesCountedSeparately();
+    std::vector<PurchaseResult> results(lines.size(), PurchaseResult{PurchaseStatus::OK, "", Money()});
+    if (lines.empty()) return results;
+    auto counted = [&results]() -> std::vector<PurchaseResult>& { // one outcome per line
+        for (auto &r : results)
+            metrics().count(Op::PURCHASE_BATCH, r.status == PurchaseStatus::OK ? nullptr : purchaseStatusName(r.status));
+        return results;
+    };
+
+    struct Resolved {
+        Buyer* buyer = nullptr;
+        Item* item = nullptr;
+        Seller* seller = nullptr;
+        BankAccount* buyerAcc = nullptr;
+        BankAccount* sellerAcc = nullptr;
+        Sym tx; // interned ID once committed
+    };
+    std::vector<Resolved> res(lines.size());
+
+    // carts in order of first appearance
+    std::unordered_map<std::string, size_t> cartOf; // buyerID -> cart index
+    std::vector<std::vector<size_t>> carts;         // cart -> line indexes
+    cartOf.reserve(lines.size());
+    for (size_t i = 0; i < lines.size(); ++i) {
+        auto ins = cartOf.emplace(lines[i].buyerID, carts.size());
+        if (ins.second) carts.emplace_back();
+        carts[ins.first->second].push_back(i);
+    }
+
+    std::shared_lock<std::shared_mutex> lk(catalogMutex);
+
+    // pass 1: resolve every line (each buyer and seller once) and gather the stripes the batch touches
+    std::vector<std::mutex*> stripes;
+    std::unordered_map<std::string, std::pair<Seller*, BankAccount*>> sellerCache;
+    for (auto &cart : carts) {
+        const std::string &buyerID = lines[cart.front()].buyerID;
+        auto bit = buyers.find(buyerID);
+        BankAccount* buyerAcc = bank && bit != buyers.end() ? bank->getAccount(buyerID) : nullptr;
+        if (buyerAcc) stripes.push_back(&bank->accountLocks.forKey(buyerID));
+        for (size_t i : cart) {
+            const PurchaseLine &ln = lines[i];
+            Resolved &r = res[i];
+            if (bit == buyers.end()) { results[i].status = PurchaseStatus::UNKNOWN_BUYER; continue; }
+            auto it = items.find(ln.itemID);
+            auto oit = itemOwner.find(ln.itemID);
+            if (it == items.end() || oit == itemOwner.end()) { results[i].status = PurchaseStatus::UNKNOWN_ITEM; continue; }
+            if (ln.qty <= 0) { results[i].status = PurchaseStatus::INVALID_QTY; continue; }
+            auto sc = sellerCache.find(oit->second);
+            if (sc == sellerCache.end()) {
+                auto sit = sellers.find(oit->second);
+                BankAccount* sellerAcc = bank ? bank->getAccount(oit->second) : nullptr;
+                sc = sellerCache.emplace(oit->second, std::make_pair(sit == sellers.end() ? nullptr : &sit->second, sellerAcc)).first;
+                if (sellerAcc) stripes.push_back(&bank->accountLocks.forKey(oit->second));
+            }
+            if (!sc->second.first || !sc->second.second || !buyerAcc) { results[i].status = PurchaseStatus::NO_ACCOUNT; continue; }
+            r.buyer = &bit->second;
+            r.buyerAcc = buyerAcc;
+            r.item = &it->second;
+            r.seller = sc->second.first;
+            r.sellerAcc = sc->second.second;
+            stripes.push_back(&itemLocks.forKey(ln.itemID));
+        }
+    }
+    MultiLock rec(std::move(stripes));
+
+    // pass 2: validate cart by cart against stock and balance as left by the carts accepted before it
+    std::unordered_map<Item*, int> stockUsed; // units taken by accepted lines so far
+    stockUsed.reserve(lines.size());
+    std::vector<size_t> committed;
+    committed.reserve(lines.size());
+    for (auto &cart : carts) {
+        bool ok = true;
+        Money cartTotal;
+        size_t taken = 0; // lines of this cart already counted in stockUsed
+        for (size_t i : cart) {
+            if (results[i].status != PurchaseStatus::OK) { ok = false; break; }
+            Item* item = res[i].item;
+            int &used = stockUsed[item];
+            if (!item->canSell(used + lines[i].qty)) { results[i].status = PurchaseStatus::OUT_OF_STOCK; ok = false; break; }
+            used += lines[i].qty;
+            ++taken;
+            results[i].total = item->price * lines[i].qty;
+            cartTotal += results[i].total;
+        }
+        if (ok && res[cart.front()].buyerAcc->balance < cartTotal) {
+            for (size_t i : cart) results[i].status = PurchaseStatus::INSUFFICIENT_FUNDS;
+            ok = false;
+        }
+        if (ok) {
+            committed.insert(committed.end(), cart.begin(), cart.end());
+            continue;
+        }
+        for (size_t k = 0; k < taken; ++k) stockUsed[res[cart[k]].item] -= lines[cart[k]].qty;
+        for (size_t i : cart) {
+            if (results[i].status == PurchaseStatus::OK) results[i].status = PurchaseStatus::CART_REJECTED;
+            results[i].total = Money();
+        }
+    }
+    if (committed.empty()) return counted();
+
+    // pass 3: settle one net transfer per buyer/seller pair, then stock and records
+    std::map<std::pair<BankAccount*, BankAccount*>, Money> transfers;
+    for (size_t i : committed) transfers[{res[i].buyerAcc, res[i].sellerAcc}] += results[i].total;
+    for (auto &t : transfers) {
+        t.first.first->withdraw(t.second, date, "purchase cart");
+        t.first.second->deposit(t.second, date, "sale cart");
+        bank->noteActivity(*t.first.first, date);
+        bank->noteActivity(*t.first.second, date);
+    }
+
+    // only committed lines are logged; on replay they commit again from the same state.
+    // Logged before the orders become visible, as in tryPurchaseWithID.
+    std::string logRec = "PB|" + std::to_string(date.day);
+    for (size_t i : committed)
+        logRec += "|" + txids[i] + "," + lines[i].buyerID + "," + lines[i].itemID + "," + std::to_string(lines[i].qty);
+    if (wal) wal->append(logRec);
+    {
+        std::lock_guard<std::mutex> tlk(txMutex);
+        for (size_t i : committed) {
+            const PurchaseLine &ln = lines[i];
+            noteID(txids[i]);
+            res[i].item->sell(ln.qty);
+            Sym tid(txids[i]);
+            Transaction &stored = transactions[tid] = Transaction(tid, date, ln.buyerID, res[i].seller->userID,
+                                                                    ln.itemID, res[i].item->name, ln.qty,
+                                                                    results[i].total, TransactionStatus::PAID);
+            res[i].tx = tid;
+            txByDay[date].push_back(&stored);
+            indexPaid(stored);
+            itemSales.add(stored.itemID, ln.qty);
+            buyerActivity.add(date, stored.buyerID);
+            sellerActivity.add(date, stored.sellerID);
+            results[i].transactionID = txids[i];
+        }
+    }
+    for (size_t i : committed) indexStock(*res[i].item);
+    for (size_t i : committed) {
+        res[i].buyer->orderIDs.push_back(res[i].tx);
+        res[i].seller->saleTxIDs.push_back(res[i].tx);
+    }
+    return counted();
+}
+
+std::vector<Item> Store::listItems(const std::string& after, size_t limit) const {
+    OpTimer t(Op::LIST_ITEMS);
+    std::shared_lock<std::shared_mutex> lk(catalogMutex);
+    std::vector<Item> out;
+    for (auto it = items.upper_bound(after); it != items.end() && out.size() < limit; ++it) {
+        std::lock_guard<std::mutex> ilk(itemLocks.forKey(it->first));
+        out.push_back(it->second);
+    }
+    return out;
+}
+
+std::string Store::searchItems(const CatalogIndex::Query& q, const std::string& token, size_t limit,
+                               std::vector<Item>& out) const {
+    OpTimer t(Op::SEARCH_ITEMS);
+    out.clear();
+    std::shared_lock<std::shared_mutex> lk(catalogMutex);
+    std::vector<const Item*> hits;
+    std::string next;
+    {
+        std::shared_lock<std::shared_mutex> slk(searchMutex);
+        next = search.search(q, token, limit, hits);
+    }
+    out.reserve(hits.size());
+    for (const Item* i : hits) {
+        std::lock_guard<std::mutex> ilk(itemLocks.forKey(i->itemID));
+        out.push_back(*i);
+    }
+    return next;
+}
+
+void Store::indexStock(const Item& item) {
+    // no searchMutex: the stock mirror is atomic, and the index only gains items under an
+    // exclusive catalogMutex (addItem), which the caller's shared hold keeps out
+    search.setStock(&item, item.stock);
+}
+
+std::string Store::sellerOf(const std::string& itemID) const {
+    std::shared_lock<std::shared_mutex> lk(catalogMutex);
+    auto it = itemOwner.find(itemID);
+    if (it == itemOwner.end()) return "";
+    return it->second;
+}
+
+void Store::rebuildIndexes() {
+    itemOwner.clear();
+    itemOwner.reserve(items.size());
+    for (auto &p : sellers) {
+        for (auto &iid : p.second.itemIDs) itemOwner[iid] = p.first;
+    }
+
+    // buyers first so a (legacy) username clash resolves the same way the old linear login did
+    usersByName.clear();
+    usersByName.reserve(buyers.size() + sellers.size());
+    for (auto &p : buyers) usersByName.emplace(p.second.username, &p.second);
+    for (auto &p : sellers) usersByName.emplace(p.second.username, &p.second);
+
+    // the map is in interning order, which depends on how the data was loaded: rebuild
+    // day buckets and queues in ID order, which is issue order (genID zero-pads)
+    std::vector<Transaction*> byID;
+    byID.reserve(transactions.size());
+    for (auto &p : transactions) byID.push_back(&p.second);
+    std::sort(byID.begin(), byID.end(), [](const Transaction* a, const Transaction* b) {
+        return Sym::ByText()(a->transactionID, b->transactionID);
+    });
+    txByDay.clear();
+    txSeq = 0;
+    for (auto *t : byID) {
+        txByDay[t->date].push_back(t);
+        noteID(t->transactionID);
+    }
+
+    paidIndex.clear();
+    pendingBySeller.clear();
+    for (auto *t : byID)
+        if (t->status == TransactionStatus::PAID) indexPaid(*t);
+
+    itemSales.clear();
+    for (auto &p : items) itemSales.add(p.first, p.second.soldCount);
+    search.clear();
+    for (auto &p : items) search.add(&p.second);
+    buyerActivity.clear();
+    sellerActivity.clear();
+    Date today = Date::today();
+    auto d = txByDay.find(today);
+    if (d != txByDay.end()) {
+        for (auto *t : d->second) {
+            buyerActivity.add(today, t->buyerID);
+            sellerActivity.add(today, t->sellerID);
+        }
+    }
+    if (bank) bank->rebuildActivity();
 }
 
 std::vector<Transaction> Store::listTransactionsLastKDays(int k) const {
     std::vector<Transaction> out;
-    std::string t = Bank::todayDate();
-    for (auto &p : transactions) {
-        if (Bank::daysBetween(t, p.second.date) <= k) out.push_back(p.second);
-    }
+    visitTransactionsLastKDays(k, "", SIZE_MAX, [&out](const Transaction& t) { out.push_back(t); });
     return out;
 }
 
+std::string Store::visitTransactionsLastKDays(int k, const std::string& token, size_t limit,
+                                              const TxVisitor& visit) const {
+    OpTimer t(Op::REPORT_TRANSACTIONS);
+    // token "<day>:<index in that day's bucket>"; buckets only grow, so a position stays put
+    Date from = Date::today() - k;
+    Date at = from;
+    size_t pos = 0;
+    size_t colon = token.find(':');
+    if (colon != std::string::npos) {
+        std::from_chars(token.data(), token.data() + colon, at.day);
+        std::from_chars(token.data() + colon + 1, token.data() + token.size(), pos);
+        if (at < from) { at = from; pos = 0; }
+    }
+    std::lock_guard<std::mutex> lk(txMutex);
+    auto d = txByDay.lower_bound(at);
+    if (d != txByDay.end() && d->first != at) pos = 0;
+    size_t n = 0;
+    for (; d != txByDay.end(); ++d, pos = 0) {
+        for (; pos < d->second.size(); ++pos) {
+            if (n == limit) return std::to_string(d->first.day) + ":" + std::to_string(pos);
+            visit(*d->second[pos]);
+            ++n;
+        }
+    }
+    return "";
+}
+
+TxColumns Store::transactionColumns() const {
+    TxColumns cols;
+    std::lock_guard<std::mutex> lk(txMutex);
+    cols.reserve(transactions.size());
+    for (auto &p : transactions) cols.append(p.second);
+    return cols;
+}
+
 std::vector<Transaction> Store::listPaidNotCompleted() const {
     std::vector<Transaction> out;
-    for (auto &p : transactions) {
-        if (p.second.status == TransactionStatus::PAID) out.push_back(p.second);
-    }
+    visitPaidNotCompleted("", SIZE_MAX, [&out](const Transaction& t) { out.push_back(t); });
     return out;
 }
 
+std::string Store::visitPaidNotCompleted(const std::string& token, size_t limit, const TxVisitor& visit) const {
+    OpTimer t(Op::REPORT_PAID);
+    // token: the ID to resume at
+    std::lock_guard<std::mutex> lk(txMutex);
+    auto it = token.empty() ? paidIndex.begin() : paidIndex.lower_bound(token);
+    for (size_t n = 0; it != paidIndex.end(); ++it, ++n) {
+        if (n == limit) return it->first.str();
+        visit(*it->second);
+    }
+    return "";
+}
+
+void Store::indexPaid(Transaction& t) {
+    paidIndex.emplace_hint(paidIndex.end(), t.transactionID, &t); // IDs are issued in order
+    PendingQueue &q = pendingBySeller[t.sellerID];
+    q.orders.push_back(&t);
+    ++q.open;
+}
+
+bool Store::settle(Transaction& t, TransactionStatus to) {
+    if (t.status != TransactionStatus::PAID) return false;
+    t.status = to;
+    paidIndex.erase(t.transactionID);
+    PendingQueue &q = pendingBySeller[t.sellerID];
+    --q.open;
+    // settled orders behind a PAID front stay queued; drop them once they are the majority
+    if (q.orders.size() > 64 && q.open < q.orders.size() / 2)
+        q.orders.erase(std::remove_if(q.orders.begin(), q.orders.end(),
+                                      [](const Transaction* o) { return o->status != TransactionStatus::PAID; }),
+                       q.orders.end());
+    return true;
+}
+
+bool Store::completeTransaction(const std::string& sellerID, const std::string& txid) {
+    OpTimer t(Op::COMPLETE);
+    {
+        std::lock_guard<std::mutex> lk(txMutex);
+        auto it = findByText(transactions, txid);
+        if (it == transactions.end() || it->second.sellerID != sellerID) return t.fail("not_found");
+        if (!settle(it->second, TransactionStatus::COMPLETED)) return t.fail("not_paid");
+    }
+    if (wal) wal->append("CO|" + sellerID + "|" + txid);
+    return true;
+}
+
+bool Store::cancelTransaction(const std::string& userID, const std::string& txid, Date date) {
+    OpTimer timer(Op::CANCEL);
+    if (!bank) return timer.fail("no_account");
+    std::shared_lock<std::shared_mutex> lk(catalogMutex);
+    Transaction t;
+    {
+        std::lock_guard<std::mutex> tlk(txMutex);
+        auto it = findByText(transactions, txid);
+        if (it == transactions.end()) return timer.fail("not_found");
+        if (it->second.status != TransactionStatus::PAID) return timer.fail("not_paid");
+        if (it->second.buyerID != userID && it->second.sellerID != userID) return timer.fail("not_allowed");
+        t = it->second;
+    }
+    auto item = items.find(t.itemID);
+    BankAccount* ba = bank->getAccount(t.buyerID);
+    BankAccount* sa = bank->getAccount(t.sellerID);
+    if (item == items.end() || !ba || !sa) return timer.fail("no_account");
+
+    // the same stripes the purchase took; the refund comes out of the seller's proceeds
+    MultiLock rec{&itemLocks.forKey(t.itemID),
+                  &bank->accountLocks.forKey(t.buyerID),
+                  &bank->accountLocks.forKey(t.sellerID)};
+    if (sa->balance < t.totalPrice) return timer.fail("seller_funds");
+    {
+        std::lock_guard<std::mutex> tlk(txMutex);
+        if (!settle(transactions.find(t.transactionID)->second, TransactionStatus::CANCELED))
+            return timer.fail("not_paid"); // completed meanwhile
+        itemSales.add(t.itemID, -t.quantity);
+    }
+    sa->withdraw(t.totalPrice, date, "refund sale " + t.itemID);
+    ba->deposit(t.totalPrice, date, "refund " + t.itemID);
+    bank->noteActivity(*sa, date);
+    bank->noteActivity(*ba, date);
+    item->second.restock(t.quantity);
+    indexStock(item->second);
+
+    if (wal) wal->append("CA|" + userID + "|" + txid + "|" + std::to_string(date.day));
+    return true;
+}
+
+bool Store::nextPending(const std::string& sellerID, Transaction& out) {
+    Sym key;
+    if (!Sym::find(sellerID, key)) return false;
+    std::lock_guard<std::mutex> lk(txMutex);
+    auto q = pendingBySeller.find(key);
+    if (q == pendingBySeller.end()) return false;
+    auto &orders = q->second.orders;
+    while (!orders.empty() && orders.front()->status != TransactionStatus::PAID) orders.pop_front();
+    if (orders.empty()) return false;
+    out = *orders.front();
+    return true;
+}
+
+size_t Store::pendingCount(const std::string& sellerID) const {
+    Sym key;
+    if (!Sym::find(sellerID, key)) return 0;
+    std::lock_guard<std::mutex> lk(txMutex);
+    auto q = pendingBySeller.find(key);
+    return q == pendingBySeller.end() ? 0 : q->second.open;
+}
+
+size_t Store::completePending(const std::string& sellerID, size_t max) {
+    OpTimer t(Op::COMPLETE_PENDING);
+    Sym key;
+    if (!Sym::find(sellerID, key)) return 0;
+    size_t done = 0;
+    std::string ids;
+    {
+        std::lock_guard<std::mutex> lk(txMutex);
+        auto q = pendingBySeller.find(key);
+        if (q == pendingBySeller.end()) return 0;
+        auto &orders = q->second.orders;
+        while (done < max && !orders.empty()) {
+            Transaction *t = orders.front();
+            orders.pop_front();
+            if (!settle(*t, TransactionStatus::COMPLETED)) continue;
+            ++done;
+            if (!wal) continue;
+            if (!ids.empty()) ids += ',';
+            ids += t->transactionID.str();
+        }
+    }
+    // logged by ID: queue order is not reproducible on replay (rebuilt by a load)
+    if (done && wal) wal->append("CM|" + sellerID + "|" + ids);
+    return done;
+}
+
 std::vector<std::pair<std::string,int>> Store::mostFrequentItems(int m) const {
+    OpTimer t(Op::REPORT_TOP_ITEMS);
+    std::vector<std::pair<Sym,int>> top;
+    std::shared_lock<std::shared_mutex> lk(catalogMutex);
+    {
+        std::lock_guard<std::mutex> tlk(txMutex);
+        top = itemSales.top(m);
+    }
     std::vector<std::pair<std::string,int>> vec;
-    for (auto &p : items) vec.emplace_back(p.second.name, p.second.soldCount);
-    std::sort(vec.begin(), vec.end(), [](auto &a, auto &b){ return a.second > b.second; });
-    if ((int)vec.size() > m) vec.resize(m);
+    vec.reserve(top.size());
+    for (auto &e : top) {
+        auto it = items.find(e.first);
+        if (it != items.end()) vec.emplace_back(it->second.name, e.second);
+    }
     return vec;
 }
 
+Money Store::spendingLastKDays(const std::string& buyerID, int k) const {
+    OpTimer t(Op::REPORT_SPENDING);
+    std::shared_lock<std::shared_mutex> lk(catalogMutex);
+    auto bit = buyers.find(buyerID);
+    if (bit == buyers.end() || !bank) return Money();
+    std::lock_guard<std::mutex> blk(bank->accountLocks.forKey(buyerID));
+    std::lock_guard<std::mutex> tlk(txMutex);
+    // a buyer's own orders are far fewer than a whole day's worth of store traffic,
+    // so walk them and compare each date against the window start
+    Money total;
+    Date from = Date::today() - k;
+    for (auto &tid : bit->second.orderIDs) {
+        auto it = transactions.find(tid);
+        if (it != transactions.end() && it->second.date >= from &&
+            it->second.status != TransactionStatus::CANCELED) // refunded
+            total += it->second.totalPrice;
+    }
+    return total;
+}
+
 std::vector<std::pair<std::string,int>> Store::mostActiveBuyersPerDay(int topN) const {
-    std::map<std::string,int> counts; // buyer -> count today
-    std::string t = Bank::todayDate();
-    for (auto &p : transactions) {
-        if (p.second.date == t) counts[p.second.buyerID]++;
-    }
-    std::vector<std::pair<std::string,int>> vec(counts.begin(), counts.end());
-    std::sort(vec.begin(), vec.end(), [](auto &a, auto &b){ return a.second > b.second; });
-    if ((int)vec.size() > topN) vec.resize(topN);
-    return vec;
+    OpTimer t(Op::REPORT_ACTIVE_USERS);
+    std::vector<std::pair<Sym,int>> top;
+    {
+        std::lock_guard<std::mutex> lk(txMutex);
+        top = buyerActivity.top(Date::today(), topN);
+    }
+    return std::vector<std::pair<std::string,int>>(top.begin(), top.end());
 }
 
 std::vector<std::pair<std::string,int>> Store::mostActiveSellersPerDay(int topN) const {
-    std::map<std::string,int> counts; // seller -> count today
-    std::string t = Bank::todayDate();
-    for (auto &p : transactions) {
-        if (p.second.date == t) counts[p.second.sellerID]++;
-    }
-    std::vector<std::pair<std::string,int>> vec(counts.begin(), counts.end());
-    std::sort(vec.begin(), vec.end(), [](auto &a, auto &b){ return a.second > b.second; });
-    if ((int)vec.size() > topN) vec.resize(topN);
-    return vec;
+    OpTimer t(Op::REPORT_ACTIVE_USERS);
+    std::vector<std::pair<Sym,int>> top;
+    {
+        std::lock_guard<std::mutex> lk(txMutex);
+        top = sellerActivity.top(Date::today(), topN);
+    }
+    return std::vector<std::pair<std::string,int>>(top.begin(), top.end());
 }
 
 std::string Store::genID(const std::string& prefix) {
-    static std::mt19937_64 rng((unsigned)std::chrono::high_resolution_clock::now().time_since_epoch().count());
-    std::uniform_int_distribution<int> dist(1000, 9999);
-    std::ostringstream ss;
-    ss << prefix << dist(rng);
-    return ss.str();
+    uint64_t n = txSeq.fetch_add(1, std::memory_order_relaxed) + 1;
+    std::string id(prefix.size() + kIDDigits, '0');
+    std::copy(prefix.begin(), prefix.end(), id.begin());
+    for (size_t pos = id.size(); n > 0 && pos > prefix.size(); n /= 10) id[--pos] = char('0' + n % 10);
+    return id;
+}
+
+void Store::noteID(const std::string& id) {
+    uint64_t n = idNumber(id);
+    uint64_t cur = txSeq.load(std::memory_order_relaxed);
+    while (cur < n && !txSeq.compare_exchange_weak(cur, n, std::memory_order_relaxed)) {}
+}
+
+uint64_t Store::idNumber(const std::string& id) {
+    size_t pos = id.size();
+    while (pos > 0 && id[pos - 1] >= '0' && id[pos - 1] <= '9') --pos;
+    uint64_t n = 0;
+    for (; pos < id.size(); ++pos) n = n * 10 + uint64_t(id[pos] - '0');
+    return n;
 }
@@ -3,19 +3,98 @@
 
 #include "models.h"
 #include "bank.h"
+#include "catalog_index.h"
+#include "leaderboard.h"
+#include "lock_stripes.h"
+#include "tx_columns.h"
+#include "wal.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <map>
+#include <memory_resource>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
 #include <vector>
 #include <string>
 
+enum class PurchaseStatus {
+    OK,
+    UNKNOWN_BUYER,
+    UNKNOWN_ITEM,
+    NO_ACCOUNT,         // buyer or seller has no bank account (or no bank is attached)
+    INVALID_QTY,
+    OUT_OF_STOCK,
+    INSUFFICIENT_FUNDS, // the cart's total exceeds the buyer's balance
+    CART_REJECTED       // line was fine, another line of the same cart failed
+};
+const char* purchaseStatusName(PurchaseStatus s); // "ok", "out_of_stock", ...
+
+struct PurchaseLine {
+    std::string buyerID;
+    std::string itemID;
+    int qty;
+};
+
+struct PurchaseResult {
+    PurchaseStatus status;
+    std::string transactionID; // set when status == OK
+    Money total;
+};
+
 class Store {
 public:
     std::map<std::string, Buyer> buyers;   // userID -> Buyer
     std::map<std::string, Seller> sellers; // userID -> Seller
     std::map<std::string, Item> items;     // itemID -> Item
-    std::map<std::string, Transaction> transactions; // txID -> Transaction
+    std::pmr::map<Sym, Transaction, Sym::ById> transactions{recordPool()}; // txID -> Transaction (Sym id order)
     Bank* bank; // reference to bank for payments
+    WriteAheadLog* wal; // logs every store mutation when set
+    uint64_t walSeq;    // last WAL record reflected in this state (kept in snapshots)
+
+    // secondary indexes (kept in sync by the mutators, rebuilt by rebuildIndexes)
+    std::unordered_map<std::string, Sym> itemOwner;      // itemID -> sellerID
+    std::unordered_map<std::string, User*> usersByName;     // username -> buyer or seller
+    std::map<Date, std::vector<const Transaction*>> txByDay; // day -> transactions of that day
+    // leaderboards, updated by the purchase paths: units sold per item (all time),
+    // transactions per buyer / seller on the current day
+    Leaderboard itemSales;
+    DailyLeaderboard buyerActivity, sellerActivity;
+    // PAID transactions by ID (listPaidNotCompleted) and per seller in purchase order
+    // (fulfilment queues). Completed/canceled entries leave paidIndex at once and a
+    // queue when they reach its front, or when they outnumber its open entries.
+    struct PendingQueue {
+        std::deque<Transaction*> orders;
+        size_t open = 0; // entries still PAID
+    };
+    std::map<Sym, Transaction*, Sym::ByText> paidIndex;
+    std::unordered_map<Sym, PendingQueue> pendingBySeller;
+    // item search by name words, price and stock (searchItems); every change to an
+    // item's price or stock is mirrored here while the item's stripe is held
+    CatalogIndex search;
 
-    Store() : bank(nullptr) {}
+    // Concurrency (all public operations below are thread-safe; loaders and
+    // rebuildIndexes are not and must run alone). Lock order, outermost first:
+    //   catalogMutex -> item / account stripes (via MultiLock) -> txMutex or searchMutex
+    // catalogMutex: shape of buyers/sellers/items and the user/owner indexes (exclusive to add entries).
+    // itemLocks:    an item's stock, price and counters.
+    // account stripe (bank->accountLocks) of a user: their balance, and Buyer::orderIDs / Seller::saleTxIDs.
+    // txMutex:      transactions (incl. status), txByDay, the leaderboards and the PAID indexes.
+    // searchMutex:  the search index's words, items and prices (never held together with txMutex);
+    //               its stock mirror is atomic and written under the item's stripe alone.
+    mutable std::shared_mutex catalogMutex;
+    mutable LockStripes itemLocks;
+    mutable std::mutex txMutex;
+    mutable std::shared_mutex searchMutex;
+
+    // last issued transaction sequence number; seeded from loaded IDs by rebuildIndexes
+    std::atomic<uint64_t> txSeq{0};
+
+    Store() : bank(nullptr), wal(nullptr), walSeq(0) {}
+    Store(const Store&) = delete;
+    Store& operator=(const Store&) = delete;
     void setBank(Bank* b);
 
     bool registerBuyer(const std::string& id, const std::string& uname, const std::string& pass);
@@ -23,22 +102,70 @@ public:
     User* login(const std::string& username, const std::string& password);
 
     bool addItem(const std::string& sellerID, const std::string& itemID,
-                 const std::string& name, double price, int stock);
+                 const std::string& name, Money price, int stock);
     bool replenishItem(const std::string& sellerID, const std::string& itemID, int qty);
     bool discardItem(const std::string& sellerID, const std::string& itemID, int qty);
-    bool setItemPrice(const std::string& sellerID, const std::string& itemID, double price);
+    bool setItemPrice(const std::string& sellerID, const std::string& itemID, Money price);
+
+    bool purchase(const std::string& buyerID, const std::string& itemID, int qty, Date date);
+    bool purchaseWithID(const std::string& txid, const std::string& buyerID,
+                        const std::string& itemID, int qty, Date date); // purchase under a given tx ID (WAL replay)
+    PurchaseStatus tryPurchaseWithID(const std::string& txid, const std::string& buyerID,
+                                     const std::string& itemID, int qty, Date date); // same, saying why it failed
 
-    bool purchase(const std::string& buyerID, const std::string& itemID, int qty, const std::string& date);
+    // Bulk checkout. All lines of one buyer form a cart that commits all-or-nothing.
+    // Money moves once per buyer/seller pair; every committed line still gets its own Transaction.
+    std::vector<PurchaseResult> purchaseBatch(const std::vector<PurchaseLine>& lines, Date date);
+    std::vector<PurchaseResult> purchaseBatchWithIDs(const std::vector<PurchaseLine>& lines,
+                                                     const std::vector<std::string>& txids, Date date);
+
+    // Lifecycle: PAID -> COMPLETED by the seller, or PAID -> CANCELED by the buyer or
+    // seller (the buyer is refunded from the seller's account and the units restocked).
+    bool completeTransaction(const std::string& sellerID, const std::string& txid);
+    bool cancelTransaction(const std::string& userID, const std::string& txid, Date date);
+    // Fulfilment: a seller's PAID orders, oldest first.
+    bool nextPending(const std::string& sellerID, Transaction& out); // false if none
+    size_t pendingCount(const std::string& sellerID) const;
+    size_t completePending(const std::string& sellerID, size_t max); // bulk; returns how many completed
 
     std::vector<Transaction> listTransactionsLastKDays(int k) const;
     std::vector<Transaction> listPaidNotCompleted() const;
+    // Paged forms. Each call visits at most `limit` matches, starting at `token` ("" = from
+    // the start), and returns the token to continue from ("" once nothing is left).
+    // Rows are references into the store, passed while txMutex is held: the visitor must
+    // not call back into the Store. Order: by day, then insertion / by transaction ID.
+    using TxVisitor = std::function<void(const Transaction&)>;
+    std::string visitTransactionsLastKDays(int k, const std::string& token, size_t limit,
+                                           const TxVisitor& visit) const;
+    std::string visitPaidNotCompleted(const std::string& token, size_t limit, const TxVisitor& visit) const;
     std::vector<std::pair<std::string,int>> mostFrequentItems(int m) const;
+    Money spendingLastKDays(const std::string& buyerID, int k) const;
 
     std::vector<std::pair<std::string,int>> mostActiveBuyersPerDay(int topN) const;
     std::vector<std::pair<std::string,int>> mostActiveSellersPerDay(int topN) const;
 
+    // Copies of up to `limit` items with IDs after `after` ("" = from the first), in ID order.
+    std::vector<Item> listItems(const std::string& after, size_t limit) const;
+    // A page of the items matching q, as copies (token contract of CatalogIndex::search).
+    // The copies are taken just after the query, so stock may have moved since it matched.
+    std::string searchItems(const CatalogIndex::Query& q, const std::string& token, size_t limit,
+                            std::vector<Item>& out) const;
+
+    // indexes
+    std::string sellerOf(const std::string& itemID) const; // "" if unknown
+    TxColumns transactionColumns() const; // columnar copy of transactions as they are now, for analytics
+    void rebuildIndexes();
+    void indexPaid(Transaction& t);                       // txMutex held
+    void indexStock(const Item& item);                    // the item's stripe and catalogMutex (shared) held
+    bool settle(Transaction& t, TransactionStatus to);    // txMutex held; false unless t was PAID
+
     // helpers
-    static std::string genID(const std::string& prefix);
+    // Next ID from a process-wide monotonic counter, e.g. TX000000001234. The number is
+    // zero-padded to a fixed width, so IDs sort (as strings) in the order they were issued.
+    std::string genID(const std::string& prefix);
+    void noteID(const std::string& id); // keeps the counter ahead of an ID issued elsewhere (load, replay)
+    static uint64_t idNumber(const std::string& id); // numeric part of an ID, 0 if none
+    static const int kIDDigits = 12;
 };
 
 #endif // STORE_H
@@ -0,0 +1,136 @@
+#include "symbol.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <ostream>
+
+namespace {
+
+// Strings live in fixed-size chunks that are never reallocated, so str() reads
+// without locking.
+const uint32_t kChunkBits = 16;
+const uint32_t kChunkSize = 1u << kChunkBits;
+const uint32_t kMaxChunks = 1u << 16;
+
+// The text -> id index is split in shards by hash, each an open-addressing table of
+// (hash tag << 32 | id) slots, 0 = empty. Lookups probe without locking; inserting
+// takes the shard's mutex, fills the string's chunk slot first and publishes the table
+// slot with release order. A full table is replaced by a doubled copy and the old one
+// is kept (never freed), so a reader still probing it stays safe; it can only miss a
+// string interned meanwhile, and intern() then looks again under the lock.
+const int kShardBits = 6;
+
+struct Slots {
+    size_t mask;
+    std::unique_ptr<std::atomic<uint64_t>[]> v;
+    explicit Slots(size_t n) : mask(n - 1), v(new std::atomic<uint64_t>[n]) {
+        for (size_t i = 0; i < n; ++i) v[i].store(0, std::memory_order_relaxed);
+    }
+};
+
+struct Shard {
+    std::atomic<Slots*> slots{new Slots(256)};
+    size_t used = 0;
+    std::mutex mu;
+};
+
+struct Table {
+    std::atomic<std::string*> chunks[kMaxChunks] = {};
+    Shard shards[1 << kShardBits];
+    std::atomic<uint32_t> count{1}; // id 0 is ""
+
+    Table() { chunks[0].store(new std::string[kChunkSize], std::memory_order_release); }
+
+    const std::string& at(uint32_t id) const {
+        return chunks[id >> kChunkBits].load(std::memory_order_acquire)[id & (kChunkSize - 1)];
+    }
+
+    // id of s, 0 if absent
+    uint32_t lookup(const Slots& t, std::string_view s, uint64_t h) const {
+        uint32_t tag = (uint32_t)(h >> 32);
+        for (size_t i = h & t.mask;; i = (i + 1) & t.mask) {
+            uint64_t e = t.v[i].load(std::memory_order_acquire);
+            if (e == 0) return 0;
+            if ((uint32_t)(e >> 32) == tag && at((uint32_t)e) == s) return (uint32_t)e;
+        }
+    }
+
+    static void place(Slots& t, uint64_t e, uint64_t h) {
+        size_t i = h & t.mask;
+        while (t.v[i].load(std::memory_order_relaxed) != 0) i = (i + 1) & t.mask;
+        t.v[i].store(e, std::memory_order_release);
+    }
+
+    // with sh.mu held and s absent
+    uint32_t insert(Shard& sh, std::string_view s, uint64_t h) {
+        uint32_t id = count.fetch_add(1, std::memory_order_relaxed);
+        std::atomic<std::string*> &c = chunks[id >> kChunkBits];
+        std::string* chunk = c.load(std::memory_order_acquire);
+        if (!chunk) { // another shard may be filling the same new chunk
+            std::string* fresh = new std::string[kChunkSize];
+            if (c.compare_exchange_strong(chunk, fresh, std::memory_order_acq_rel)) chunk = fresh;
+            else delete[] fresh;
+        }
+        chunk[id & (kChunkSize - 1)].assign(s.data(), s.size());
+
+        Slots* t = sh.slots.load(std::memory_order_relaxed);
+        if ((sh.used + 1) * 2 > t->mask + 1) {
+            Slots* bigger = new Slots((t->mask + 1) * 2);
+            for (size_t i = 0; i <= t->mask; ++i) {
+                uint64_t e = t->v[i].load(std::memory_order_relaxed);
+                if (e) place(*bigger, e, hashOf(at((uint32_t)e)));
+            }
+            sh.slots.store(bigger, std::memory_order_release);
+            t = bigger; // the old table is retired, not freed
+        }
+        place(*t, (uint64_t)(uint32_t)(h >> 32) << 32 | id, h);
+        ++sh.used;
+        return id;
+    }
+
+    static uint64_t hashOf(std::string_view s) { return std::hash<std::string_view>{}(s); }
+    Shard& shardOf(uint64_t h) { return shards[h >> (64 - kShardBits)]; }
+};
+
+Table& table() {
+    static Table* t = new Table(); // never destroyed: Syms may be used during static teardown
+    return *t;
+}
+
+} // namespace
+
+uint32_t Sym::intern(std::string_view s) {
+    if (s.empty()) return 0;
+    Table& t = table();
+    uint64_t h = Table::hashOf(s);
+    Shard &sh = t.shardOf(h);
+    if (uint32_t id = t.lookup(*sh.slots.load(std::memory_order_acquire), s, h)) return id;
+    std::lock_guard<std::mutex> lk(sh.mu);
+    if (uint32_t id = t.lookup(*sh.slots.load(std::memory_order_relaxed), s, h)) return id;
+    return t.insert(sh, s, h);
+}
+
+bool Sym::find(std::string_view s, Sym& out) {
+    if (s.empty()) {
+        out.id = 0;
+        return true;
+    }
+    Table& t = table();
+    uint64_t h = Table::hashOf(s);
+    uint32_t id = t.lookup(*t.shardOf(h).slots.load(std::memory_order_acquire), s, h);
+    if (id == 0) return false;
+    out.id = id;
+    return true;
+}
+
+size_t Sym::tableSize() {
+    return table().count.load(std::memory_order_relaxed);
+}
+
+const std::string& Sym::str() const {
+    return table().at(id);
+}
+
+std::ostream& operator<<(std::ostream& os, Sym s) {
+    return os << s.str();
+}
@@ -0,0 +1,79 @@
+#ifndef SYMBOL_H
+#define SYMBOL_H
+
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+
+// Interned string: equal strings share one id in a process-wide table. A Sym is
+// 4 bytes, compares and hashes as an integer, and str() returns the single stored
+// copy (which never moves). Ordering is by id, i.e. first-interned first, not alphabetical.
+// Looking a string up (find, or interning one already there) takes no lock.
+class Sym {
+public:
+    Sym() = default; // ""
+    Sym(const std::string& s) : id(intern(s)) {}
+    Sym(const char* s) : id(intern(s)) {}
+    explicit Sym(std::string_view s) : id(intern(s)) {}
+
+    // Looks s up without interning it (for keys from outside: a miss must not grow the table).
+    static bool find(std::string_view s, Sym& out);
+    static size_t tableSize();
+
+    const std::string& str() const;
+    operator const std::string&() const { return str(); }
+    uint32_t raw() const { return id; }
+    bool empty() const { return id == 0; }
+
+    bool operator==(Sym o) const { return id == o.id; }
+    bool operator!=(Sym o) const { return id != o.id; }
+    bool operator<(Sym o) const { return id < o.id; }
+
+    // Id order, for maps keyed by Sym. Text keys do not compile: look them up with
+    // findByText, so a key that was never interned is a miss and not a new entry.
+    struct ById {
+        using is_transparent = void;
+        bool operator()(Sym a, Sym b) const { return a.id < b.id; }
+        template <class T> bool operator()(Sym, const T&) const = delete;
+        template <class T> bool operator()(const T&, Sym) const = delete;
+    };
+
+    // Alphabetical order, only for containers that are report output (the order must not
+    // depend on when strings were interned); transparent, so text lookups never intern.
+    struct ByText {
+        using is_transparent = void;
+        bool operator()(Sym a, Sym b) const { return a.id != b.id && a.str() < b.str(); }
+        bool operator()(Sym a, std::string_view b) const { return std::string_view(a.str()) < b; }
+        bool operator()(std::string_view a, Sym b) const { return a < std::string_view(b.str()); }
+        bool operator()(Sym a, const std::string& b) const { return a.str() < b; }
+        bool operator()(const std::string& a, Sym b) const { return a < b.str(); }
+    };
+
+private:
+    static uint32_t intern(std::string_view s);
+    uint32_t id = 0;
+};
+
+// m.find(text) for a map keyed by Sym, without interning text.
+template <class Map> auto findByText(Map& m, std::string_view text) -> decltype(m.end()) {
+    Sym s;
+    return Sym::find(text, s) ? m.find(s) : m.end();
+}
+
+inline bool operator==(Sym a, const std::string& b) { return a.str() == b; }
+inline bool operator==(const std::string& a, Sym b) { return a == b.str(); }
+inline bool operator!=(Sym a, const std::string& b) { return a.str() != b; }
+inline bool operator!=(const std::string& a, Sym b) { return a != b.str(); }
+inline std::string operator+(const std::string& a, Sym b) { return a + b.str(); }
+inline std::string operator+(const char* a, Sym b) { return a + b.str(); }
+std::ostream& operator<<(std::ostream& os, Sym s);
+
+namespace std {
+template <> struct hash<Sym> {
+    size_t operator()(Sym s) const noexcept { return std::hash<uint32_t>{}(s.raw()); }
+};
+}
+
+#endif // SYMBOL_H
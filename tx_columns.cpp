@@ -0,0 +1,86 @@
+#include "tx_columns.h"
+
+uint32_t Dictionary::encode(Sym s) {
+    auto it = index.find(s);
+    if (it != index.end()) return it->second;
+    uint32_t code = (uint32_t)values.size();
+    values.push_back(s);
+    index.emplace(s, code);
+    return code;
+}
+
+int64_t Dictionary::find(Sym s) const {
+    auto it = index.find(s);
+    return it == index.end() ? -1 : (int64_t)it->second;
+}
+
+void Dictionary::clear() {
+    index.clear();
+    values.clear();
+}
+
+void TxColumns::clear() {
+    rows.clear();
+    day.clear();
+    buyer.clear();
+    seller.clear();
+    item.clear();
+    quantity.clear();
+    totalPrice.clear();
+    status.clear();
+    buyers.clear();
+    sellers.clear();
+    items.clear();
+}
+
+void TxColumns::reserve(size_t n) {
+    rows.reserve(n);
+    day.reserve(n);
+    buyer.reserve(n);
+    seller.reserve(n);
+    item.reserve(n);
+    quantity.reserve(n);
+    totalPrice.reserve(n);
+    status.reserve(n);
+}
+
+size_t TxColumns::append(const Transaction& t) {
+    rows.push_back(&t);
+    day.push_back(t.date.day);
+    buyer.push_back(buyers.encode(t.buyerID));
+    seller.push_back(sellers.encode(t.sellerID));
+    item.push_back(items.encode(t.itemID));
+    quantity.push_back(t.quantity);
+    totalPrice.push_back(t.totalPrice.cents);
+    status.push_back((uint8_t)t.status);
+    return rows.size() - 1;
+}
+
+static std::vector<int> countByCode(const std::vector<int32_t>& day, const std::vector<uint32_t>& codes,
+                                    size_t ncodes, Date from, Date to) {
+    std::vector<int> counts(ncodes, 0);
+    const int32_t lo = from.day, hi = to.day;
+    const size_t n = day.size();
+    for (size_t i = 0; i < n; ++i) {
+        if (day[i] >= lo && day[i] <= hi) ++counts[codes[i]];
+    }
+    return counts;
+}
+
+std::vector<int> TxColumns::countByBuyer(Date from, Date to) const {
+    return countByCode(day, buyer, buyers.size(), from, to);
+}
+
+std::vector<int> TxColumns::countBySeller(Date from, Date to) const {
+    return countByCode(day, seller, sellers.size(), from, to);
+}
+
+std::vector<size_t> TxColumns::rowsWithStatus(TransactionStatus s) const {
+    std::vector<size_t> out;
+    const uint8_t want = (uint8_t)s;
+    const size_t n = status.size();
+    for (size_t i = 0; i < n; ++i) {
+        if (status[i] == want) out.push_back(i);
+    }
+    return out;
+}
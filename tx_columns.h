@@ -0,0 +1,55 @@
+#ifndef TX_COLUMNS_H
+#define TX_COLUMNS_H
+
+#include "models.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Dense integer codes for a set of symbols (0, 1, 2, ... in first-seen order).
+class Dictionary {
+public:
+    uint32_t encode(Sym s);
+    int64_t find(Sym s) const; // -1 if never encoded
+    const std::string& decode(uint32_t code) const { return values[code].str(); }
+    size_t size() const { return values.size(); }
+    void clear();
+
+private:
+    std::unordered_map<Sym, uint32_t> index;
+    std::vector<Sym> values;
+};
+
+// Structure-of-arrays copy of the transaction table for ad-hoc analytics scans
+// (Store::transactionColumns). Row i of every column describes the same transaction;
+// rows[i] points back at the full record in Store::transactions for materializing results.
+// The store's own reports do not scan it: the PAID list, the top-item and daily rankings
+// and per-buyer spending are answered from indexes kept by the mutators (paidIndex,
+// the leaderboards, Buyer::orderIDs) without a scan, so the copy is built only on request
+// rather than maintained on every purchase and status change.
+class TxColumns {
+public:
+    std::vector<const Transaction*> rows;
+    std::vector<int32_t> day;
+    std::vector<uint32_t> buyer;  // codes in buyers
+    std::vector<uint32_t> seller; // codes in sellers
+    std::vector<uint32_t> item;   // codes in items
+    std::vector<int32_t> quantity;
+    std::vector<int64_t> totalPrice; // Money::cents
+    std::vector<uint8_t> status;  // TransactionStatus
+
+    Dictionary buyers, sellers, items;
+
+    size_t size() const { return rows.size(); }
+    void clear();
+    void reserve(size_t n);
+    size_t append(const Transaction& t); // returns the row index
+
+    // counts per dictionary code of the rows whose day is in [from, to]
+    std::vector<int> countByBuyer(Date from, Date to) const;
+    std::vector<int> countBySeller(Date from, Date to) const;
+    std::vector<size_t> rowsWithStatus(TransactionStatus s) const;
+};
+
+#endif // TX_COLUMNS_H
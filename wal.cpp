@@ -0,0 +1,287 @@
+#include "wal.h"
+#include "metrics.h"
+#include "store.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+WriteAheadLog::WriteAheadLog(size_t groupSize, int maxDelayMs)
+    : groupSize(groupSize ? groupSize : 1), maxDelayMs(maxDelayMs) {}
+
+WriteAheadLog::~WriteAheadLog() {
+    close();
+}
+
+bool WriteAheadLog::open(const std::string& path, uint64_t lastSeq, int64_t keepBytes) {
+    close();
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) return false;
+    struct stat st;
+    if (keepBytes >= 0 && fstat(fd, &st) == 0 && st.st_size > keepBytes &&
+        (ftruncate(fd, keepBytes) != 0 || fsync(fd) != 0)) {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    seq = lastSeq;
+    sinceTruncate = 0;
+    stopping = false;
+    flusher = std::thread(&WriteAheadLog::flusherLoop, this);
+    return true;
+}
+
+void WriteAheadLog::close() {
+    if (fd < 0) return;
+    {
+        std::lock_guard<std::mutex> lk(mu);
+        stopping = true;
+    }
+    cv.notify_all();
+    if (flusher.joinable()) flusher.join();
+    flush();
+    ::close(fd);
+    fd = -1;
+}
+
+uint64_t WriteAheadLog::append(const std::string& record) {
+    std::unique_lock<std::mutex> lk(mu);
+    if (fd < 0) return 0;
+    uint64_t s = ++seq;
+    pending += std::to_string(s);
+    pending += '|';
+    pending += record;
+    pending += '\n';
+    ++sinceTruncate;
+    if (++pendingCount >= groupSize) writeOut(lk);
+    return s;
+}
+
+// Hands the pending buffer to the caller's thread for write + fsync. The lock is
+// released during I/O so other threads keep appending into the next group.
+bool WriteAheadLog::writeOut(std::unique_lock<std::mutex>& lk) {
+    cv.wait(lk, [this]{ return !writing; });
+    if (pending.empty()) return true;
+    std::string batch;
+    batch.swap(pending);
+    pendingCount = 0;
+    writing = true;
+    lk.unlock();
+
+    bool ok = true;
+    {
+        OpTimer timer(Op::WAL_FLUSH);
+        const char* p = batch.data();
+        size_t left = batch.size();
+        while (left > 0) {
+            ssize_t n = ::write(fd, p, left);
+            if (n < 0) { ok = false; break; }
+            p += n;
+            left -= (size_t)n;
+        }
+        ok = ok && fdatasync(fd) == 0;
+        if (!ok) timer.fail("io_error");
+    }
+
+    lk.lock();
+    writing = false;
+    cv.notify_all();
+    return ok;
+}
+
+bool WriteAheadLog::flush() {
+    std::unique_lock<std::mutex> lk(mu);
+    if (fd < 0) return false;
+    return writeOut(lk);
+}
+
+bool WriteAheadLog::truncate() {
+    std::unique_lock<std::mutex> lk(mu);
+    if (fd < 0) return false;
+    cv.wait(lk, [this]{ return !writing; });
+    pending.clear();
+    pendingCount = 0;
+    sinceTruncate = 0;
+    return ftruncate(fd, 0) == 0 && fsync(fd) == 0;
+}
+
+uint64_t WriteAheadLog::lastSeq() const {
+    std::lock_guard<std::mutex> lk(mu);
+    return seq;
+}
+
+uint64_t WriteAheadLog::recordsSinceTruncate() const {
+    std::lock_guard<std::mutex> lk(mu);
+    return sinceTruncate;
+}
+
+void WriteAheadLog::flusherLoop() {
+    std::unique_lock<std::mutex> lk(mu);
+    while (!stopping) {
+        cv.wait_for(lk, std::chrono::milliseconds(maxDelayMs));
+        if (!pending.empty()) writeOut(lk);
+    }
+}
+
+static std::vector<std::string> splitFields(const std::string& line, size_t maxFields) {
+    // the last field takes the rest of the line, so names and notes may contain '|'
+    std::vector<std::string> out;
+    size_t start = 0;
+    while (out.size() + 1 < maxFields) {
+        size_t bar = line.find('|', start);
+        if (bar == std::string::npos) break;
+        out.push_back(line.substr(start, bar - start));
+        start = bar + 1;
+    }
+    out.push_back(line.substr(start));
+    return out;
+}
+
+namespace {
+
+struct ReplayState {
+    long applied = 0;
+    // txid -> seller of completions (CO/CM) met before the order's purchase record.
+    // Purchases are logged before their orders become visible, so this normally stays
+    // empty; it keeps such a completion from being dropped should one ever come first.
+    std::unordered_map<std::string, std::string> completeOnCreate;
+
+    void complete(Store& store, const std::string& sellerID, const std::string& txid) {
+        if (findByText(store.transactions, txid) == store.transactions.end()) completeOnCreate[txid] = sellerID;
+        else store.completeTransaction(sellerID, txid);
+    }
+
+    void created(Store& store, const std::string& txid) {
+        auto it = completeOnCreate.find(txid);
+        if (it == completeOnCreate.end()) return;
+        store.completeTransaction(it->second, txid);
+        completeOnCreate.erase(it);
+    }
+};
+
+// Applies one complete log line. False when it is not a well-formed record (a short
+// record; unparsable numbers throw).
+bool replayRecord(const std::string& line, Store& store, ReplayState& st) {
+    if (line.empty()) return true;
+    size_t bar = line.find('|');
+    if (bar == std::string::npos) return false;
+    uint64_t s = std::stoull(line.substr(0, bar));
+    if (s <= store.walSeq) return true;
+    std::string op = line.substr(bar + 1, 2);
+    std::string rest = line.size() > bar + 4 ? line.substr(bar + 4) : std::string();
+
+    if (op == "RB" || op == "RS") {
+        auto v = splitFields(rest, 3);
+        if (v.size() != 3) return false;
+        if (op == "RB") store.registerBuyer(v[0], v[1], v[2]);
+        else store.registerSeller(v[0], v[1], v[2]);
+    } else if (op == "AI") {
+        auto v = splitFields(rest, 5); // seller|item|price|stock|name
+        if (v.size() != 5) return false;
+        store.addItem(v[0], v[1], v[4], Money::parse(v[2]), std::stoi(v[3]));
+    } else if (op == "RI" || op == "DI") {
+        auto v = splitFields(rest, 3);
+        if (v.size() != 3) return false;
+        if (op == "RI") store.replenishItem(v[0], v[1], std::stoi(v[2]));
+        else store.discardItem(v[0], v[1], std::stoi(v[2]));
+    } else if (op == "SP") {
+        auto v = splitFields(rest, 3);
+        if (v.size() != 3) return false;
+        store.setItemPrice(v[0], v[1], Money::parse(v[2]));
+    } else if (op == "PU") {
+        auto v = splitFields(rest, 5); // txid|buyer|item|qty|day
+        if (v.size() != 5) return false;
+        store.purchaseWithID(v[0], v[1], v[2], std::stoi(v[3]), Date(std::stoi(v[4])));
+        st.created(store, v[0]);
+    } else if (op == "PB") {
+        auto v = splitFields(rest, (size_t)-1); // day|txid,buyer,item,qty|...
+        std::vector<PurchaseLine> lines;
+        std::vector<std::string> txids;
+        for (size_t i = 1; i < v.size(); ++i) {
+            std::istringstream ss(v[i]);
+            std::string txid, buyer, item, qty;
+            std::getline(ss, txid, ',');
+            std::getline(ss, buyer, ',');
+            std::getline(ss, item, ',');
+            std::getline(ss, qty, ',');
+            txids.push_back(txid);
+            lines.push_back({buyer, item, std::stoi(qty)});
+        }
+        store.purchaseBatchWithIDs(lines, txids, Date(std::stoi(v[0])));
+        for (auto &txid : txids) st.created(store, txid);
+    } else if (op == "CO") {
+        auto v = splitFields(rest, 2); // seller|txid
+        if (v.size() != 2) return false;
+        st.complete(store, v[0], v[1]);
+    } else if (op == "CA") {
+        auto v = splitFields(rest, 3); // user|txid|day
+        if (v.size() != 3) return false;
+        store.cancelTransaction(v[0], v[1], Date(std::stoi(v[2])));
+    } else if (op == "CM") {
+        auto v = splitFields(rest, 2); // seller|txid,txid,...
+        if (v.size() != 2) return false;
+        std::istringstream ss(v[1]);
+        std::string txid;
+        while (std::getline(ss, txid, ',')) st.complete(store, v[0], txid);
+    } else if (op == "DE" || op == "WD") {
+        auto v = splitFields(rest, 4); // account|amount|day|note
+        if (v.size() != 4) return false;
+        if (store.bank) {
+            if (op == "DE") store.bank->deposit(v[0], Money::parse(v[1]), Date(std::stoi(v[2])), v[3]);
+            else store.bank->withdraw(v[0], Money::parse(v[1]), Date(std::stoi(v[2])), v[3]);
+        }
+    } else {
+        return true; // an operation this build does not know: skip it
+    }
+    store.walSeq = s;
+    ++st.applied;
+    return true;
+}
+
+} // namespace
+
+long WriteAheadLog::replay(const std::string& path, Store& store, int64_t* validBytes) {
+    OpTimer timer(Op::WAL_REPLAY); // the replayed operations count under their own names too
+    if (validBytes) *validBytes = -1;
+    std::ifstream f(path, std::ios::binary);
+    if (!f) {
+        timer.fail("no_log");
+        return -1;
+    }
+
+    WriteAheadLog* storeWal = store.wal;
+    WriteAheadLog* bankWal = store.bank ? store.bank->wal : nullptr;
+    store.wal = nullptr;
+    if (store.bank) store.bank->wal = nullptr;
+
+    ReplayState st;
+    int64_t good = 0; // end of the last complete, well-formed record
+    std::string line;
+    while (std::getline(f, line)) {
+        if (f.eof()) break; // no trailing newline: torn write
+        int64_t end = good + (int64_t)line.size() + 1;
+        try {
+            if (!replayRecord(line, store, st)) {
+                std::cerr << "wal: malformed record at byte " << good << " of " << path
+                          << ", replay stopped there (the rest is dropped)\n";
+                timer.fail("bad_record");
+                break;
+            }
+        } catch (const std::exception& e) { // std::stoi and friends
+            std::cerr << "wal: malformed record at byte " << good << " of " << path << " (" << e.what()
+                      << "), replay stopped there (the rest is dropped)\n";
+            timer.fail("bad_record");
+            break;
+        }
+        good = end;
+    }
+    if (validBytes) *validBytes = good;
+
+    store.wal = storeWal;
+    if (store.bank) store.bank->wal = bankWal;
+    return st.applied;
+}
@@ -0,0 +1,60 @@
+#ifndef WAL_H
+#define WAL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class Store;
+
+// Append-only mutation log. Each record is one text line "seq|OP|field|...".
+// Appends are buffered and written + fsynced in groups: when groupSize records
+// are pending, or by the background flusher after maxDelayMs. append() returns
+// before its group is fsynced, so a crash can lose up to maxDelayMs (or groupSize
+// records) of mutations that were already acknowledged; call flush() first where
+// an acknowledgement must mean durable.
+class WriteAheadLog {
+public:
+    explicit WriteAheadLog(size_t groupSize = 64, int maxDelayMs = 20);
+    ~WriteAheadLog();
+
+    // Starts numbering after lastSeq. keepBytes >= 0 first cuts the file to that length
+    // (replay's validBytes), so new records never follow a torn or bad one.
+    bool open(const std::string& path, uint64_t lastSeq = 0, int64_t keepBytes = -1);
+    void close();
+    bool isOpen() const { return fd >= 0; }
+
+    uint64_t append(const std::string& record); // returns the record's sequence number (0 if closed)
+    bool flush();                               // write + fsync everything pending
+    bool truncate();                            // drop all records (after a checkpoint)
+
+    uint64_t lastSeq() const;
+    uint64_t recordsSinceTruncate() const;
+
+    // Re-applies records with seq > store.walSeq. Logging is suspended while replaying.
+    // A torn final line (crash mid-write) is ignored; a malformed record stops replay with
+    // a warning on stderr. *validBytes gets the offset just past the last good record
+    // (-1 if the log could not be read). Returns records applied, -1 on open failure.
+    static long replay(const std::string& path, Store& store, int64_t* validBytes = nullptr);
+
+private:
+    void flusherLoop();
+    bool writeOut(std::unique_lock<std::mutex>& lk);
+
+    int fd = -1;
+    size_t groupSize;
+    int maxDelayMs;
+    uint64_t seq = 0;
+    uint64_t sinceTruncate = 0;
+    size_t pendingCount = 0;
+    std::string pending;
+    bool stopping = false;
+    bool writing = false;
+    mutable std::mutex mu;
+    std::condition_variable cv;
+    std::thread flusher;
+};
+
+#endif // WAL_H